@@ -0,0 +1,105 @@
+#include "AllocCounter.hpp"
+#include <atomic>
+#include <cstdlib> // For getenv, malloc, free
+#include <cstring> // For strcmp
+#include <new>     // For std::bad_alloc
+
+namespace {
+
+// Every block carries its size in a header, so that operator delete (which is
+// not always given the size) can keep liveBytes exact. 16 bytes keeps the
+// returned pointer aligned like malloc's.
+const size_t kHeader = 16;
+
+std::atomic<size_t> g_allocations(0);
+std::atomic<size_t> g_deallocations(0);
+std::atomic<size_t> g_bytesAllocated(0);
+std::atomic<size_t> g_liveBytes(0);
+std::atomic<size_t> g_peakLiveBytes(0);
+std::atomic<AllocCounter::Hook> g_hook(NULL);
+thread_local bool t_inHook = false;
+
+// Decided on the first allocation and never changed afterwards, so that every
+// block is freed the same way it was allocated (with or without the header).
+bool countingEnabled() {
+    static const bool enabled = [] {
+        const char *value = std::getenv("BENCH_COUNT_ALLOCS");
+        return value != NULL && *value != '\0' && std::strcmp(value, "0") != 0;
+    }();
+    return enabled;
+}
+
+void updatePeak(size_t live) {
+    size_t peak = g_peakLiveBytes.load(std::memory_order_relaxed);
+    while (live > peak && !g_peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+namespace AllocCounter {
+
+bool enabled() { return countingEnabled(); }
+
+Stats current() {
+    Stats s;
+    s.allocations = g_allocations.load(std::memory_order_relaxed);
+    s.deallocations = g_deallocations.load(std::memory_order_relaxed);
+    s.bytesAllocated = g_bytesAllocated.load(std::memory_order_relaxed);
+    s.liveBytes = g_liveBytes.load(std::memory_order_relaxed);
+    s.peakLiveBytes = g_peakLiveBytes.load(std::memory_order_relaxed);
+    return s;
+}
+
+void resetPeak() { g_peakLiveBytes.store(g_liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed); }
+
+void setHook(Hook hook) { g_hook.store(hook, std::memory_order_release); }
+
+} // namespace AllocCounter
+
+/**
+ * @brief Replaced global operator new that records every allocation.
+ * @note The array, nothrow and sized variants provided by the standard
+ * library forward to these two functions, so they are counted as well.
+ * Without BENCH_COUNT_ALLOCS it is a plain malloc.
+ */
+void *operator new(std::size_t size) {
+    if (!countingEnabled()) {
+        void *p = std::malloc(size != 0 ? size : 1);
+        if (p == NULL)
+            throw std::bad_alloc();
+        return p;
+    }
+    char *block = static_cast<char *>(std::malloc(size + kHeader));
+    if (block == NULL)
+        throw std::bad_alloc();
+    *reinterpret_cast<size_t *>(block) = size;
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytesAllocated.fetch_add(size, std::memory_order_relaxed);
+    updatePeak(g_liveBytes.fetch_add(size, std::memory_order_relaxed) + size);
+    const AllocCounter::Hook hook = g_hook.load(std::memory_order_acquire);
+    if (hook != NULL && !t_inHook) {
+        t_inHook = true;
+        hook(size);
+        t_inHook = false;
+    }
+    return block + kHeader;
+}
+
+void operator delete(void *p) noexcept {
+    if (p == NULL)
+        return;
+    if (!countingEnabled()) {
+        std::free(p);
+        return;
+    }
+    char *block = static_cast<char *>(p) - kHeader;
+    g_deallocations.fetch_add(1, std::memory_order_relaxed);
+    g_liveBytes.fetch_sub(*reinterpret_cast<size_t *>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+void operator delete(void *p, std::size_t size) noexcept {
+    (void)size; // The header is authoritative.
+    operator delete(p);
+}
@@ -0,0 +1,86 @@
+#ifndef ALLOC_COUNTER_HPP
+#define ALLOC_COUNTER_HPP
+
+#include <cstddef> // For size_t
+
+/**
+ * @namespace AllocCounter
+ * @brief Heap statistics collected by the global operator new / delete
+ * replacement in AllocCounter.cpp.
+ * @note Linking AllocCounter.cpp into a program replaces operator new, but the
+ * counting is opt-in: it is on only when BENCH_COUNT_ALLOCS is set to a value
+ * other than "0" when the program starts. Otherwise operator new forwards
+ * straight to malloc, so timing benchmarks in the same program pay nothing
+ * for it. When on, every operator new in the program (including the code under
+ * test and the standard containers it uses) is counted.
+ */
+namespace AllocCounter {
+
+/**
+ * @brief Whether allocations are counted in this run (fixed at startup).
+ * @note When false, current() stays at zero and hooks are never called.
+ */
+bool enabled();
+
+/**
+ * @brief A snapshot of the counters since program start.
+ */
+struct Stats {
+    size_t allocations;    // Number of operator new calls
+    size_t deallocations;  // Number of operator delete calls
+    size_t bytesAllocated; // Sum of all requested sizes
+    size_t liveBytes;      // Requested bytes not deleted yet
+    size_t peakLiveBytes;  // Highest liveBytes since the last resetPeak()
+};
+
+Stats current();
+
+/**
+ * @brief Restarts peak tracking from the current live size.
+ */
+void resetPeak();
+
+/**
+ * @brief Function called by operator new after each counted allocation.
+ * @note Allocations made inside the hook itself are counted but do not call
+ * it again, so a hook may allocate (or call code that does, like backtrace).
+ */
+typedef void (*Hook)(size_t size);
+
+/**
+ * @brief Installs `hook` (NULL removes it). One hook for the whole program.
+ */
+void setHook(Hook hook);
+
+/**
+ * @brief Measures the heap activity of a region of code.
+ * @code
+ *   AllocCounter::Scope scope;
+ *   btc.loadDatabase("data.csv");
+ *   size_t retained = scope.retainedBytes();
+ * @endcode
+ */
+class Scope {
+  public:
+    Scope() {
+        resetPeak();
+        _begin = current();
+    }
+
+    size_t allocations() const { return current().allocations - _begin.allocations; }
+    size_t bytesAllocated() const { return current().bytesAllocated - _begin.bytesAllocated; }
+    // Bytes allocated in the scope and still alive (may "underflow" to 0 if the scope freed older memory).
+    size_t retainedBytes() const {
+        const size_t live = current().liveBytes;
+        return live > _begin.liveBytes ? live - _begin.liveBytes : 0;
+    }
+    // Highest heap size reached in the scope, above the size at its start.
+    size_t peakBytes() const { return current().peakLiveBytes - _begin.liveBytes; }
+
+  private:
+    Stats _begin;
+};
+
+} // namespace AllocCounter
+
+#endif // ALLOC_COUNTER_HPP
@@ -0,0 +1,204 @@
+#ifndef BENCH_UTILS_HPP
+#define BENCH_UTILS_HPP
+
+#include <algorithm> // For std::sort
+#include <chrono>
+#include <cstdlib> // For getenv, strtoull, strtod
+#include <fstream>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/**
+ * @namespace BenchUtils
+ * @brief Small helpers shared by the benchmark and stress programs (exNN_bench_app,
+ * exNN_stress_app) and the tools.
+ */
+namespace BenchUtils {
+
+/**
+ * @brief Monotonic stopwatch with nanosecond resolution.
+ */
+class Stopwatch {
+  public:
+    Stopwatch() : _start(std::chrono::steady_clock::now()) {}
+
+    void restart() { _start = std::chrono::steady_clock::now(); }
+
+    double elapsedNs() const {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - _start).count();
+    }
+
+    double elapsedSec() const { return elapsedNs() / 1e9; }
+
+  private:
+    std::chrono::steady_clock::time_point _start;
+};
+
+/**
+ * @brief Deterministic 64-bit PRNG (splitmix64), identical on every platform.
+ */
+class Rng {
+  public:
+    explicit Rng(unsigned long long seed) : _state(seed) {}
+
+    unsigned long long next() {
+        unsigned long long z = (_state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform integer in [lo, hi].
+    long range(long lo, long hi) { return lo + static_cast<long>(next() % static_cast<unsigned long long>(hi - lo + 1)); }
+
+    // Uniform double in [0, 1).
+    double unit() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+  private:
+    unsigned long long _state;
+};
+
+/**
+ * @brief Reads a list of sizes ("1000 10000" or "1000,10000") from an environment variable.
+ * @param name The environment variable to read.
+ * @param defaults The sizes used when the variable is unset or empty.
+ */
+inline std::vector<size_t> envSizes(const char *name, const std::vector<size_t> &defaults) {
+    const char *value = std::getenv(name);
+    if (value == NULL || *value == '\0')
+        return defaults;
+    std::vector<size_t> sizes;
+    const char *p = value;
+    while (*p) {
+        char *end;
+        unsigned long long n = std::strtoull(p, &end, 10);
+        if (end == p) {
+            ++p;
+            continue;
+        }
+        sizes.push_back(static_cast<size_t>(n));
+        p = end;
+    }
+    return sizes.empty() ? defaults : sizes;
+}
+
+/**
+ * @brief Reads a single count from an environment variable.
+ */
+inline size_t envSize(const char *name, size_t fallback) {
+    std::vector<size_t> one(1, fallback);
+    return envSizes(name, one)[0];
+}
+
+/**
+ * @brief Reads a single real number (e.g. a tolerance such as "1.5") from an environment variable.
+ * @note Falls back when the variable is unset, empty or does not start with a number.
+ */
+inline double envDouble(const char *name, double fallback) {
+    const char *value = std::getenv(name);
+    if (value == NULL || *value == '\0')
+        return fallback;
+    char *end;
+    const double x = std::strtod(value, &end);
+    return end == value ? fallback : x;
+}
+
+/**
+ * @brief Returns the median of the samples (the vector is reordered).
+ */
+inline double median(std::vector<double> samples) {
+    if (samples.empty())
+        return 0.0;
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+/**
+ * @brief Appends "<name> <size> <value>" lines to the file named by $BENCH_SAMPLES.
+ * @details The performance scripts point BENCH_SAMPLES at a temporary file and
+ * feed the samples of one series to tools/complexity_fit. Does nothing when
+ * the variable is unset.
+ */
+inline void recordSample(const char *name, size_t size, double value) {
+    const char *path = std::getenv("BENCH_SAMPLES");
+    if (path == NULL || *path == '\0')
+        return;
+    std::ofstream log(path, std::ios::app);
+    log << name << ' ' << size << ' ' << value << '\n';
+}
+
+/**
+ * @brief A streambuf that discards everything and only counts bytes and lines.
+ * @note Used instead of a std::stringstream so that capturing millions of
+ * output lines does not turn into a memory benchmark of its own.
+ */
+class CountingBuf : public std::streambuf {
+  public:
+    CountingBuf() : _bytes(0), _lines(0) {}
+
+    size_t bytes() const { return _bytes; }
+    size_t lines() const { return _lines; }
+    void reset() { _bytes = _lines = 0; }
+
+  protected:
+    int_type overflow(int_type c) override {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            ++_bytes;
+            if (traits_type::to_char_type(c) == '\n')
+                ++_lines;
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override {
+        _bytes += static_cast<size_t>(n);
+        for (std::streamsize i = 0; i < n; ++i) {
+            if (s[i] == '\n')
+                ++_lines;
+        }
+        return n;
+    }
+
+  private:
+    size_t _bytes;
+    size_t _lines;
+};
+
+/**
+ * @brief RAII helper that points std::cout and std::cerr at CountingBuf instances.
+ * @param skipFormatting When true, both streams are also put in the bad state,
+ * so every operator<< returns before formatting anything. Comparing a run with
+ * and without it gives the time the program spends formatting its output.
+ */
+class SilenceStdStreams {
+  public:
+    explicit SilenceStdStreams(bool skipFormatting = false)
+        : _oldOut(std::cout.rdbuf(&out)), _oldErr(std::cerr.rdbuf(&err)) {
+        if (skipFormatting) {
+            std::cout.setstate(std::ios::badbit);
+            std::cerr.setstate(std::ios::badbit);
+        }
+    }
+    ~SilenceStdStreams() {
+        std::cout.clear();
+        std::cerr.clear();
+        std::cout.rdbuf(_oldOut);
+        std::cerr.rdbuf(_oldErr);
+    }
+
+    CountingBuf out;
+    CountingBuf err;
+
+  private:
+    std::streambuf *_oldOut;
+    std::streambuf *_oldErr;
+
+    SilenceStdStreams(const SilenceStdStreams &);
+    SilenceStdStreams &operator=(const SilenceStdStreams &);
+};
+
+} // namespace BenchUtils
+
+#endif // BENCH_UTILS_HPP
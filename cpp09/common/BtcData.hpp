@@ -0,0 +1,389 @@
+#ifndef BTC_DATA_HPP
+#define BTC_DATA_HPP
+
+#include "BenchUtils.hpp"
+#include <cmath>  // For log
+#include <cstdio> // For FILE, fopen, fwrite
+#include <cstdlib> // For strtol
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @namespace BtcData
+ * @brief Calendar arithmetic and file writers for BitcoinExchange workloads.
+ * @note Dates are handled as a day number counted from 1970-01-01, so that
+ * leap years are always right and stepping by N days is a plain addition.
+ */
+namespace BtcData {
+
+/**
+ * @brief Converts a civil date to the number of days since 1970-01-01.
+ * @note Howard Hinnant's days_from_civil algorithm (proleptic Gregorian calendar).
+ */
+inline long daysFromCivil(long y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const long era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<long>(doe) - 719468;
+}
+
+/**
+ * @brief Converts a day number back to a civil date (inverse of daysFromCivil).
+ */
+inline void civilFromDays(long z, long &y, unsigned &m, unsigned &d) {
+    z += 719468;
+    const long era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<long>(yoe) + era * 400 + (m <= 2);
+}
+
+// The range of dates that fits the "YYYY-MM-DD" format.
+const long kMinDay = daysFromCivil(1, 1, 1);
+const long kMaxDay = daysFromCivil(9999, 12, 31);
+// Default first row of generated databases (the day after the genesis block).
+const long kDefaultStartDay = daysFromCivil(2009, 1, 2);
+
+/**
+ * @brief Writes "YYYY-MM-DD" (10 characters, no terminator) and returns the end pointer.
+ */
+inline char *formatDate(char *out, long day) {
+    long y;
+    unsigned m, d;
+    civilFromDays(day, y, m, d);
+    out[0] = static_cast<char>('0' + y / 1000 % 10);
+    out[1] = static_cast<char>('0' + y / 100 % 10);
+    out[2] = static_cast<char>('0' + y / 10 % 10);
+    out[3] = static_cast<char>('0' + y % 10);
+    out[4] = '-';
+    out[5] = static_cast<char>('0' + m / 10);
+    out[6] = static_cast<char>('0' + m % 10);
+    out[7] = '-';
+    out[8] = static_cast<char>('0' + d / 10);
+    out[9] = static_cast<char>('0' + d % 10);
+    return out + 10;
+}
+
+inline std::string dateString(long day) {
+    char buf[10];
+    formatDate(buf, day);
+    return std::string(buf, 10);
+}
+
+/**
+ * @brief Writes an unsigned integer in decimal and returns the end pointer.
+ */
+inline char *formatUnsigned(char *out, unsigned long long v) {
+    char tmp[20];
+    int n = 0;
+    do {
+        tmp[n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n)
+        *out++ = tmp[--n];
+    return out;
+}
+
+/**
+ * @brief Writes a fixed-point value given in hundredths ("12345" -> "123.45").
+ */
+inline char *formatCents(char *out, unsigned long long cents) {
+    out = formatUnsigned(out, cents / 100);
+    *out++ = '.';
+    *out++ = static_cast<char>('0' + cents / 10 % 10);
+    *out++ = static_cast<char>('0' + cents % 10);
+    return out;
+}
+
+/**
+ * @brief Buffered writer that flushes with large fwrite() calls.
+ * @note The path "-" writes to stdout.
+ */
+class BufferedFile {
+  public:
+    explicit BufferedFile(const std::string &path, size_t capacity = 1 << 20)
+        : _fp(path == "-" ? stdout : std::fopen(path.c_str(), "wb")), _buf(capacity), _len(0) {
+        if (_fp == NULL)
+            throw std::runtime_error("could not open " + path);
+    }
+    ~BufferedFile() { close(); }
+
+    // Returns a pointer where at least `n` bytes can be written.
+    char *reserve(size_t n) {
+        if (_len + n > _buf.size())
+            flush();
+        return &_buf[_len];
+    }
+    void commit(char *end) { _len = static_cast<size_t>(end - &_buf[0]); }
+
+    void write(const std::string &s) {
+        char *p = reserve(s.size());
+        s.copy(p, s.size());
+        commit(p + s.size());
+    }
+
+    void flush() {
+        if (_len && std::fwrite(&_buf[0], 1, _len, _fp) != _len)
+            throw std::runtime_error("write error");
+        _len = 0;
+    }
+
+    void close() {
+        if (_fp == NULL)
+            return;
+        flush();
+        if (_fp == stdout)
+            std::fflush(_fp);
+        else
+            std::fclose(_fp);
+        _fp = NULL;
+    }
+
+  private:
+    std::FILE *_fp;
+    std::vector<char> _buf;
+    size_t _len;
+
+    BufferedFile(const BufferedFile &);
+    BufferedFile &operator=(const BufferedFile &);
+};
+
+/**
+ * @brief Deterministic PRNG used by the generators (see BenchUtils::Rng).
+ */
+typedef BenchUtils::Rng Rng;
+
+/**
+ * @brief Distribution of the number of days between two consecutive rows.
+ *  - FIXED     : always `a` days ("fixed:1" is the classic daily history)
+ *  - UNIFORM   : uniform in [a, b] days
+ *  - GEOMETRIC : geometric with mean `a` days (bursty, with occasional long holes)
+ */
+struct GapSpec {
+    enum Kind { FIXED, UNIFORM, GEOMETRIC };
+
+    Kind kind;
+    long a;
+    long b;
+
+    GapSpec(Kind k = FIXED, long first = 1, long second = 1) : kind(k), a(first), b(second) {}
+
+    long next(Rng &rng) const {
+        if (kind == UNIFORM)
+            return rng.range(a, b);
+        if (kind == GEOMETRIC) {
+            if (a <= 1)
+                return 1;
+            const double p = 1.0 / static_cast<double>(a);
+            return 1 + static_cast<long>(std::log(1.0 - rng.unit()) / std::log(1.0 - p));
+        }
+        return a;
+    }
+
+    // Parses "fixed:N", "uniform:A-B" or "geometric:MEAN". Returns false on error.
+    static bool parse(const std::string &text, GapSpec &out) {
+        const size_t colon = text.find(':');
+        const std::string kind = text.substr(0, colon);
+        const std::string args = colon == std::string::npos ? "" : text.substr(colon + 1);
+        char *end;
+        const long first = std::strtol(args.c_str(), &end, 10);
+        if (kind == "daily" && args.empty()) {
+            out = GapSpec(FIXED, 1, 1);
+            return true;
+        }
+        if (args.empty() || first < 1)
+            return false;
+        if (kind == "fixed" && *end == '\0') {
+            out = GapSpec(FIXED, first, first);
+            return true;
+        }
+        if (kind == "geometric" && *end == '\0') {
+            out = GapSpec(GEOMETRIC, first, first);
+            return true;
+        }
+        if (kind == "uniform" && *end == '-') {
+            char *end2;
+            const long second = std::strtol(end + 1, &end2, 10);
+            if (*end2 != '\0' || second < first)
+                return false;
+            out = GapSpec(UNIFORM, first, second);
+            return true;
+        }
+        return false;
+    }
+};
+
+/**
+ * @brief Everything needed to reproduce a generated database.
+ * @note The shape fields default to the classic export: ascending dates, one
+ * row per date, "500.00"-style rates and LF line endings.
+ */
+struct DbSpec {
+    size_t rows;
+    unsigned long long seed;
+    GapSpec gap;
+    long startDay;
+    bool descending;   // Rows from the latest date down to startDay
+    double duplicates; // Probability that a row repeats the previous date
+    int rateDigits;    // Extra random fraction digits appended to every rate
+    bool crlf;         // "\r\n" line endings
+
+    DbSpec(size_t n = 0, unsigned long long s = 42, GapSpec g = GapSpec(), long start = kDefaultStartDay)
+        : rows(n), seed(s), gap(g), startDay(start), descending(false), duplicates(0), rateDigits(0),
+          crlf(false) {}
+
+    /**
+     * @brief Applies a comma-separated shape list:
+     * "descending", "dup:FRACTION", "longrate:DIGITS" and "crlf".
+     * @return false on an unknown or malformed item.
+     */
+    bool parseShape(const std::string &text) {
+        size_t pos = 0;
+        while (pos <= text.size()) {
+            const size_t comma = text.find(',', pos);
+            const std::string item = text.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+            char *end;
+            if (item == "descending") {
+                descending = true;
+            } else if (item == "crlf") {
+                crlf = true;
+            } else if (item.compare(0, 4, "dup:") == 0) {
+                duplicates = std::strtod(item.c_str() + 4, &end);
+                if (*end != '\0' || duplicates < 0 || duplicates >= 1)
+                    return false;
+            } else if (item.compare(0, 9, "longrate:") == 0) {
+                const long digits = std::strtol(item.c_str() + 9, &end, 10);
+                if (*end != '\0' || digits < 0 || digits > 4096)
+                    return false;
+                rateDigits = static_cast<int>(digits);
+            } else {
+                return false;
+            }
+            if (comma == std::string::npos)
+                break;
+            pos = comma + 1;
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Number of distinct dates a database starting at `startDay` with a
+ * fixed `gap` can hold before it runs past 9999-12-31.
+ */
+inline size_t calendarCapacity(long startDay, long gap) { return static_cast<size_t>((kMaxDay - startDay) / gap + 1); }
+
+/**
+ * @brief Writes a "date,exchange_rate" database described by `spec`.
+ * @return The number of times the dates ran out of the calendar (past
+ * 9999-12-31, or below spec.startDay when descending) and restarted. Non-zero
+ * means the database repeats dates beyond what spec.duplicates asked for.
+ */
+inline size_t writeDatabase(BufferedFile &out, const DbSpec &spec) {
+    // A descending database walks the same gaps down from the date the
+    // ascending one would end on, so both cover the same range.
+    long lastDay = spec.startDay;
+    if (spec.descending) {
+        Rng probe(spec.seed);
+        for (size_t i = 1; i < spec.rows && lastDay <= kMaxDay; ++i) {
+            probe.range(-1000, 1000);
+            if (spec.duplicates == 0 || probe.unit() >= spec.duplicates)
+                lastDay += spec.gap.next(probe);
+        }
+        if (lastDay > kMaxDay)
+            lastDay = kMaxDay;
+    }
+    Rng rng(spec.seed);
+    Rng extra(spec.seed ^ 0x5eedULL); // Rate digits, kept apart so the dates match the plain shape
+    const char *eol = spec.crlf ? "\r\n" : "\n";
+    size_t wraps = 0;
+    long day = spec.descending ? lastDay : spec.startDay;
+    long long cents = 50000; // 500.00, then a random walk of at most +-10.00 per row
+    out.write(std::string("date,exchange_rate") + eol);
+    for (size_t i = 0; i < spec.rows; ++i) {
+        char *p = out.reserve(64 + static_cast<size_t>(spec.rateDigits));
+        p = formatDate(p, day);
+        *p++ = ',';
+        p = formatCents(p, static_cast<unsigned long long>(cents));
+        for (int d = 0; d < spec.rateDigits; ++d)
+            *p++ = static_cast<char>('0' + extra.next() % 10);
+        for (const char *e = eol; *e; ++e)
+            *p++ = *e;
+        out.commit(p);
+        if (i + 1 == spec.rows)
+            break;
+        cents += rng.range(-1000, 1000);
+        if (cents < 0)
+            cents = 0;
+        if (spec.duplicates > 0 && rng.unit() < spec.duplicates)
+            continue;
+        const long gap = spec.gap.next(rng);
+        day += spec.descending ? -gap : gap;
+        if (day > kMaxDay || day < spec.startDay) {
+            day = spec.descending ? lastDay : spec.startDay;
+            ++wraps;
+        }
+    }
+    return wraps;
+}
+
+inline size_t writeDatabase(const std::string &path, const DbSpec &spec) {
+    BufferedFile out(path);
+    const size_t wraps = writeDatabase(out, spec);
+    out.close();
+    return wraps;
+}
+
+/**
+ * @brief Everything needed to reproduce a generated "date | value" input file.
+ * @note Query dates are uniform over [startDay, startDay + spanDays) and every
+ * line is valid, so each line produces exactly one result on stdout as long as
+ * the database starts on or before startDay.
+ */
+struct InputSpec {
+    size_t lines;
+    unsigned long long seed;
+    long startDay;
+    long spanDays;
+
+    InputSpec(size_t n = 0, unsigned long long s = 42, long start = kDefaultStartDay, long span = 3650)
+        : lines(n), seed(s), startDay(start), spanDays(span) {}
+};
+
+inline void writeInput(BufferedFile &out, const InputSpec &spec) {
+    Rng rng(spec.seed);
+    out.write("date | value\n");
+    for (size_t i = 0; i < spec.lines; ++i) {
+        char *p = out.reserve(64);
+        p = formatDate(p, spec.startDay + rng.range(0, spec.spanDays - 1));
+        *p++ = ' ';
+        *p++ = '|';
+        *p++ = ' ';
+        // Half integers ("42"), half decimals ("42.17"), all within [0, 1000].
+        const unsigned long long cents = static_cast<unsigned long long>(rng.range(0, 100000));
+        if (i & 1)
+            p = formatUnsigned(p, cents / 100);
+        else
+            p = formatCents(p, cents);
+        *p++ = '\n';
+        out.commit(p);
+    }
+}
+
+inline void writeInput(const std::string &path, const InputSpec &spec) {
+    BufferedFile out(path);
+    writeInput(out, spec);
+    out.close();
+}
+
+} // namespace BtcData
+
+#endif // BTC_DATA_HPP
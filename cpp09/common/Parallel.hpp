@@ -0,0 +1,165 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>  // For fflush
+#include <cstdlib> // For getenv, strtoul
+#include <functional>
+#include <iostream>
+#include <poll.h>
+#include <string>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @namespace Parallel
+ * @brief Splits a stress test into shards that run on every core.
+ * @note Code under test that writes to std::cout (RPN::evaluate) cannot share
+ * one process between threads, because std::cout's buffer is process-global.
+ * forkShards() gives each shard its own process instead. Code that only
+ * computes (PmergeMe::mergeInsertSort) can use runThreads() or forEachJob().
+ */
+namespace Parallel {
+
+/**
+ * @brief Number of workers: $PARALLEL_JOBS if set, otherwise the number of cores.
+ */
+inline unsigned workerCount() {
+    const char *value = std::getenv("PARALLEL_JOBS");
+    if (value != NULL && *value != '\0') {
+        const unsigned long n = std::strtoul(value, NULL, 10);
+        if (n > 0)
+            return static_cast<unsigned>(n);
+    }
+    const unsigned cores = std::thread::hardware_concurrency();
+    return cores > 0 ? cores : 1;
+}
+
+/**
+ * @brief Outcome of one forked shard.
+ */
+struct ShardResult {
+    int status;         // Raw wait status of the shard process
+    std::string report; // Everything the shard function returned
+
+    ShardResult() : status(-1) {}
+
+    bool ok() const { return WIFEXITED(status) && WEXITSTATUS(status) == 0; }
+};
+
+/**
+ * @brief Runs `fn(shard, shards)` in `shards` child processes at once and
+ * collects the string each one returns.
+ * @details The report travels back through a pipe, so a shard that crashes
+ * still delivers nothing worse than an empty report and a signal status.
+ */
+inline std::vector<ShardResult> forkShards(unsigned shards,
+                                           const std::function<std::string(unsigned, unsigned)> &fn) {
+    std::vector<ShardResult> results(shards);
+    std::vector<pid_t> pids(shards, -1);
+    std::vector<int> fds(shards, -1);
+    // Buffered output would otherwise be written again by every child.
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(NULL);
+    for (unsigned s = 0; s < shards; ++s) {
+        int p[2];
+        if (pipe(p) < 0)
+            break;
+        const pid_t pid = fork();
+        if (pid == 0) {
+            close(p[0]);
+            const std::string report = fn(s, shards);
+            size_t done = 0;
+            while (done < report.size()) {
+                const ssize_t n = write(p[1], report.data() + done, report.size() - done);
+                if (n <= 0)
+                    break;
+                done += static_cast<size_t>(n);
+            }
+            _exit(0);
+        }
+        close(p[1]);
+        if (pid < 0) {
+            close(p[0]);
+            break;
+        }
+        pids[s] = pid;
+        fds[s] = p[0];
+    }
+
+    // Read all pipes together, so that no shard blocks on a full pipe.
+    for (;;) {
+        std::vector<struct pollfd> polled;
+        std::vector<unsigned> owner;
+        for (unsigned s = 0; s < shards; ++s) {
+            if (fds[s] < 0)
+                continue;
+            struct pollfd pfd;
+            pfd.fd = fds[s];
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            polled.push_back(pfd);
+            owner.push_back(s);
+        }
+        if (polled.empty())
+            break;
+        if (poll(&polled[0], polled.size(), -1) < 0 && errno != EINTR)
+            break;
+        for (size_t i = 0; i < polled.size(); ++i) {
+            if (polled[i].revents == 0)
+                continue;
+            char buf[65536];
+            const ssize_t n = read(polled[i].fd, buf, sizeof(buf));
+            if (n > 0) {
+                results[owner[i]].report.append(buf, static_cast<size_t>(n));
+            } else if (n == 0 || errno != EINTR) {
+                close(polled[i].fd);
+                fds[owner[i]] = -1;
+            }
+        }
+    }
+    for (unsigned s = 0; s < shards; ++s) {
+        if (pids[s] > 0) {
+            while (waitpid(pids[s], &results[s].status, 0) < 0 && errno == EINTR) {
+            }
+        }
+    }
+    return results;
+}
+
+/**
+ * @brief Runs `fn(worker, workers)` on `workers` threads at once and waits for all.
+ * @note `fn` must not write to std::cout, and must keep its results per worker
+ * (for example in a vector indexed by `worker`) to avoid sharing.
+ */
+inline void runThreads(unsigned workers, const std::function<void(unsigned, unsigned)> &fn) {
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+    for (unsigned w = 0; w < workers; ++w)
+        threads.push_back(std::thread(fn, w, workers));
+    for (size_t i = 0; i < threads.size(); ++i)
+        threads[i].join();
+}
+
+/**
+ * @brief Runs `fn(job, worker)` for every job in [0, jobs) on a pool of `workers` threads.
+ * @note Jobs are handed out one at a time from a shared counter, so a worker that
+ * draws cheap jobs takes more of them. Put the expensive jobs first so the pool
+ * does not finish on one long job. Same rules for `fn` as runThreads().
+ */
+inline void forEachJob(size_t jobs, unsigned workers, const std::function<void(size_t, unsigned)> &fn) {
+    std::atomic<size_t> next(0);
+    runThreads(workers, [&](unsigned worker, unsigned) {
+        for (size_t job = next++; job < jobs; job = next++)
+            fn(job, worker);
+    });
+}
+
+} // namespace Parallel
+
+#endif // PARALLEL_HPP
@@ -0,0 +1,185 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <cerrno>
+#include <cstring> // For memset, strerror
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @namespace PerfCounters
+ * @brief Hardware and software event counters of the calling thread, read
+ * through perf_event_open(2).
+ * @note Hardware events (instructions, cache and branch misses) are often
+ * unavailable: in virtual machines and containers, on non-Linux systems, or
+ * when kernel.perf_event_paranoid forbids them. Each event is opened on its own,
+ * so whatever is available is reported and the rest shows up as invalid.
+ * The software events (task-clock, page faults) are the fallback that works
+ * in most of those environments.
+ */
+namespace PerfCounters {
+
+/**
+ * @brief One counter value after Group::stop().
+ */
+struct Reading {
+    const char *name;
+    bool valid;               // False if the event could not be opened or read
+    unsigned long long value; // Scaled up if the kernel multiplexed the counter
+};
+
+/**
+ * @brief A set of counters that are started and stopped together.
+ * @code
+ *   PerfCounters::Group counters;
+ *   counters.start();
+ *   sorter.mergeInsertSort(v);
+ *   counters.stop();
+ *   std::vector<PerfCounters::Reading> r = counters.readings();
+ * @endcode
+ */
+class Group {
+  public:
+    // Events in reporting order; the indices are used by value().
+    enum Event { INSTRUCTIONS, CACHE_REFERENCES, CACHE_MISSES, BRANCH_MISSES, TASK_CLOCK_NS, PAGE_FAULTS, EVENT_COUNT };
+
+    Group() : _hardware(0), _error(0) {
+        static const char *const names[EVENT_COUNT] = {"instructions", "cache-references", "cache-misses",
+                                                       "branch-misses", "task-clock",       "page-faults"};
+        for (int e = 0; e < EVENT_COUNT; ++e) {
+            _readings[e].name = names[e];
+            _readings[e].valid = false;
+            _readings[e].value = 0;
+            _fds[e] = open(static_cast<Event>(e));
+            if (_fds[e] >= 0 && e < TASK_CLOCK_NS)
+                ++_hardware;
+        }
+    }
+
+    ~Group() {
+#ifdef __linux__
+        for (int e = 0; e < EVENT_COUNT; ++e) {
+            if (_fds[e] >= 0)
+                close(_fds[e]);
+        }
+#endif
+    }
+
+    // True if at least one hardware event could be opened.
+    bool hardware() const { return _hardware > 0; }
+    // True if any event at all could be opened.
+    bool available() const {
+        for (int e = 0; e < EVENT_COUNT; ++e) {
+            if (_fds[e] >= 0)
+                return true;
+        }
+        return false;
+    }
+    // Why the first failing event could not be opened (empty if all opened).
+    std::string error() const { return _error != 0 ? std::strerror(_error) : std::string(); }
+
+    void start() {
+#ifdef __linux__
+        for (int e = 0; e < EVENT_COUNT; ++e) {
+            if (_fds[e] < 0)
+                continue;
+            ioctl(_fds[e], PERF_EVENT_IOC_RESET, 0);
+            ioctl(_fds[e], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void stop() {
+#ifdef __linux__
+        for (int e = 0; e < EVENT_COUNT; ++e) {
+            if (_fds[e] >= 0)
+                ioctl(_fds[e], PERF_EVENT_IOC_DISABLE, 0);
+        }
+        for (int e = 0; e < EVENT_COUNT; ++e) {
+            _readings[e].valid = false;
+            if (_fds[e] < 0)
+                continue;
+            // value, time_enabled, time_running (PERF_FORMAT_TOTAL_TIME_*)
+            unsigned long long data[3];
+            if (::read(_fds[e], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0)
+                continue;
+            _readings[e].valid = true;
+            _readings[e].value = data[2] < data[1]
+                                     ? static_cast<unsigned long long>(static_cast<double>(data[0]) * data[1] / data[2])
+                                     : data[0];
+        }
+#endif
+    }
+
+    std::vector<Reading> readings() const { return std::vector<Reading>(_readings, _readings + EVENT_COUNT); }
+
+    const Reading &value(Event e) const { return _readings[e]; }
+
+  private:
+    int _fds[EVENT_COUNT];
+    Reading _readings[EVENT_COUNT];
+    int _hardware;
+    int _error;
+
+    int open(Event e) {
+#ifdef __linux__
+        struct perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1; // Allowed with perf_event_paranoid <= 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        switch (e) {
+        case INSTRUCTIONS:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case CACHE_REFERENCES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_REFERENCES;
+            break;
+        case CACHE_MISSES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case BRANCH_MISSES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case TASK_CLOCK_NS:
+            attr.type = PERF_TYPE_SOFTWARE;
+            attr.config = PERF_COUNT_SW_TASK_CLOCK;
+            break;
+        default:
+            attr.type = PERF_TYPE_SOFTWARE;
+            attr.config = PERF_COUNT_SW_PAGE_FAULTS;
+            break;
+        }
+        // pid 0, cpu -1: this thread, on any CPU.
+        const int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fd < 0 && _error == 0)
+            _error = errno;
+        return fd;
+#else
+        (void)e;
+        if (_error == 0)
+            _error = ENOSYS;
+        return -1;
+#endif
+    }
+
+    Group(const Group &);
+    Group &operator=(const Group &);
+};
+
+} // namespace PerfCounters
+
+#endif // PERF_COUNTERS_HPP
@@ -0,0 +1,109 @@
+#ifndef PMERGE_DATA_HPP
+#define PMERGE_DATA_HPP
+
+#include "BenchUtils.hpp"
+#include <algorithm> // For sort, swap
+#include <climits>   // For INT_MAX
+#include <string>
+#include <vector>
+
+/**
+ * @namespace PmergeData
+ * @brief Input generators for PmergeMe workloads.
+ * @note Every value is a positive int, so any list can also be passed to the
+ * PmergeMe executable as arguments.
+ */
+namespace PmergeData {
+
+/**
+ * @brief The shape of a generated sequence.
+ */
+enum Shape {
+    UNIFORM,       // Independent uniform values (what generate_numbers.sh draws)
+    SORTED,        // 1, 2, ..., n
+    REVERSED,      // n, n-1, ..., 1
+    ORGAN_PIPE,    // Ascending to the middle, then descending
+    SAWTOOTH,      // Ascending runs of about sqrt(n) values
+    FEW_UNIQUE,    // Uniform over 16 distinct values
+    NEARLY_SORTED, // Sorted, then `swaps` random pairs exchanged
+    ALL_EQUAL      // Every value the same
+};
+
+const Shape kAllShapes[] = {UNIFORM, SORTED, REVERSED, ORGAN_PIPE, SAWTOOTH, FEW_UNIQUE, NEARLY_SORTED, ALL_EQUAL};
+const size_t kShapeCount = sizeof(kAllShapes) / sizeof(kAllShapes[0]);
+
+inline const char *shapeName(Shape shape) {
+    switch (shape) {
+    case UNIFORM:
+        return "uniform";
+    case SORTED:
+        return "sorted";
+    case REVERSED:
+        return "reversed";
+    case ORGAN_PIPE:
+        return "organ-pipe";
+    case SAWTOOTH:
+        return "sawtooth";
+    case FEW_UNIQUE:
+        return "few-unique";
+    case NEARLY_SORTED:
+        return "nearly-sorted";
+    case ALL_EQUAL:
+        return "all-equal";
+    }
+    return "?";
+}
+
+/**
+ * @brief Generates `n` values of the given shape.
+ * @param swaps Number of random exchanges for NEARLY_SORTED (ignored otherwise).
+ */
+inline std::vector<int> generate(Shape shape, size_t n, unsigned long long seed = 1, size_t swaps = 10) {
+    BenchUtils::Rng rng(seed);
+    std::vector<int> v(n);
+    switch (shape) {
+    case UNIFORM:
+        for (size_t i = 0; i < n; ++i)
+            v[i] = static_cast<int>(rng.range(1, INT_MAX));
+        break;
+    case SORTED:
+    case NEARLY_SORTED:
+        for (size_t i = 0; i < n; ++i)
+            v[i] = static_cast<int>(i + 1);
+        if (shape == NEARLY_SORTED && n > 1) {
+            for (size_t s = 0; s < swaps; ++s)
+                std::swap(v[static_cast<size_t>(rng.range(0, static_cast<long>(n - 1)))],
+                          v[static_cast<size_t>(rng.range(0, static_cast<long>(n - 1)))]);
+        }
+        break;
+    case REVERSED:
+        for (size_t i = 0; i < n; ++i)
+            v[i] = static_cast<int>(n - i);
+        break;
+    case ORGAN_PIPE:
+        for (size_t i = 0; i < n; ++i)
+            v[i] = static_cast<int>(i < (n + 1) / 2 ? i + 1 : n - i);
+        break;
+    case SAWTOOTH: {
+        size_t run = 1;
+        while (run * run < n)
+            ++run;
+        for (size_t i = 0; i < n; ++i)
+            v[i] = static_cast<int>(i % run + 1);
+        break;
+    }
+    case FEW_UNIQUE:
+        for (size_t i = 0; i < n; ++i)
+            v[i] = static_cast<int>(rng.range(1, 16));
+        break;
+    case ALL_EQUAL:
+        for (size_t i = 0; i < n; ++i)
+            v[i] = 42;
+        break;
+    }
+    return v;
+}
+
+} // namespace PmergeData
+
+#endif // PMERGE_DATA_HPP
@@ -0,0 +1,262 @@
+#ifndef SUBPROCESS_HPP
+#define SUBPROCESS_HPP
+
+#include <cerrno>
+#include <cstdlib> // For setenv
+#include <ctime>   // For clock_gettime
+#include <fcntl.h>
+#include <poll.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @namespace Subprocess
+ * @brief fork/exec helpers that time a child with clock_gettime and collect its
+ * resource usage with wait4, without going through a shell or /usr/bin/time.
+ */
+namespace Subprocess {
+
+/**
+ * @brief Outcome of one child process.
+ */
+struct Result {
+    int status;        // Raw wait status (use WIFEXITED / WEXITSTATUS)
+    double elapsedSec; // Wall clock time from fork to reap
+    long maxRssKb;     // Peak resident set size of the child, in KiB
+    double userSec;    // CPU time in user mode
+    double sysSec;     // CPU time in kernel mode
+
+    Result() : status(-1), elapsedSec(0), maxRssKb(0), userSec(0), sysSec(0) {}
+
+    bool exitedWith(int code) const { return WIFEXITED(status) && WEXITSTATUS(status) == code; }
+};
+
+inline double monotonicSec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+inline double toSec(const struct timeval &tv) {
+    return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) / 1e6;
+}
+
+/**
+ * @brief Waits for `pid` with wait4 and fills in status and resource usage.
+ */
+inline void reap(pid_t pid, double startSec, Result &result) {
+    struct rusage usage;
+    pid_t r;
+    do {
+        r = wait4(pid, &result.status, 0, &usage);
+    } while (r < 0 && errno == EINTR);
+    result.elapsedSec = monotonicSec() - startSec;
+    if (r < 0)
+        return;
+#ifdef __APPLE__
+    result.maxRssKb = usage.ru_maxrss / 1024; // bytes on macOS
+#else
+    result.maxRssKb = usage.ru_maxrss; // KiB on Linux
+#endif
+    result.userSec = toSec(usage.ru_utime);
+    result.sysSec = toSec(usage.ru_stime);
+}
+
+/**
+ * @brief Builds a NULL-terminated argv array pointing into `args`.
+ */
+inline std::vector<char *> makeArgv(std::vector<std::string> &args) {
+    std::vector<char *> argv;
+    for (size_t i = 0; i < args.size(); ++i)
+        argv.push_back(&args[i][0]);
+    argv.push_back(NULL);
+    return argv;
+}
+
+/**
+ * @brief Adds `env` ("NAME=value" entries) to the environment; called in the child after fork.
+ */
+inline void applyEnv(const std::vector<std::string> &env) {
+    for (size_t i = 0; i < env.size(); ++i) {
+        const std::string::size_type eq = env[i].find('=');
+        if (eq != std::string::npos)
+            setenv(env[i].substr(0, eq).c_str(), env[i].c_str() + eq + 1, 1);
+    }
+}
+
+/**
+ * @brief Runs `args` (args[0] is looked up in PATH) with the parent's stdin,
+ * stdout and stderr, and waits for it.
+ * @note A child that cannot exec exits with status 127, like a shell would.
+ */
+inline Result run(std::vector<std::string> args) {
+    Result result;
+    std::vector<char *> argv = makeArgv(args);
+    const double start = monotonicSec();
+    const pid_t pid = fork();
+    if (pid < 0)
+        return result;
+    if (pid == 0) {
+        execvp(argv[0], &argv[0]);
+        _exit(127);
+    }
+    reap(pid, start, result);
+    return result;
+}
+
+/**
+ * @brief Runs `args` with stdout written to `stdoutPath` (for example
+ * "/dev/null"), stdin and stderr on /dev/null, and `env` added to its environment.
+ * @note A child that cannot open `stdoutPath` or exec exits with status 127.
+ */
+inline Result runToFile(std::vector<std::string> args, const char *stdoutPath,
+                        const std::vector<std::string> &env = std::vector<std::string>()) {
+    Result result;
+    std::vector<char *> argv = makeArgv(args);
+    const double start = monotonicSec();
+    const pid_t pid = fork();
+    if (pid < 0)
+        return result;
+    if (pid == 0) {
+        const int devNull = open("/dev/null", O_RDWR);
+        const int out = open(stdoutPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (devNull < 0 || out < 0)
+            _exit(127);
+        dup2(devNull, STDIN_FILENO);
+        dup2(out, STDOUT_FILENO);
+        dup2(devNull, STDERR_FILENO);
+        applyEnv(env);
+        execvp(argv[0], &argv[0]);
+        _exit(127);
+    }
+    reap(pid, start, result);
+    return result;
+}
+
+/**
+ * @brief A running child whose stdout and stderr are read through pipes.
+ */
+struct Child {
+    pid_t pid;
+    int outFd; // Read end of the child's stdout, -1 once closed
+    int errFd; // Read end of the child's stderr, -1 once closed
+    double startSec;
+
+    Child() : pid(-1), outFd(-1), errFd(-1), startSec(0) {}
+};
+
+/**
+ * @brief Starts `args` with stdin on /dev/null and stdout/stderr on pipes,
+ * with `env` ("NAME=value" entries) added to its environment.
+ * @note The read ends are close-on-exec, so children started later do not
+ * keep each other's pipes open (which would delay their EOF).
+ * @return false if the pipes or the fork could not be created.
+ */
+inline bool spawnCaptured(std::vector<std::string> args, Child &child,
+                          const std::vector<std::string> &env = std::vector<std::string>()) {
+    int out[2], err[2];
+    if (pipe(out) < 0)
+        return false;
+    if (pipe(err) < 0) {
+        close(out[0]);
+        close(out[1]);
+        return false;
+    }
+    fcntl(out[0], F_SETFD, FD_CLOEXEC);
+    fcntl(err[0], F_SETFD, FD_CLOEXEC);
+    std::vector<char *> argv = makeArgv(args);
+    child.startSec = monotonicSec();
+    child.pid = fork();
+    if (child.pid == 0) {
+        const int devNull = open("/dev/null", O_RDONLY);
+        if (devNull >= 0)
+            dup2(devNull, STDIN_FILENO);
+        dup2(out[1], STDOUT_FILENO);
+        dup2(err[1], STDERR_FILENO);
+        applyEnv(env);
+        execvp(argv[0], &argv[0]);
+        _exit(127);
+    }
+    close(out[1]);
+    close(err[1]);
+    if (child.pid < 0) {
+        close(out[0]);
+        close(err[0]);
+        return false;
+    }
+    child.outFd = out[0];
+    child.errFd = err[0];
+    return true;
+}
+
+/**
+ * @brief Appends what is available on `fd` to `dest`; closes it and sets it to -1 at EOF.
+ */
+inline void drain(int &fd, std::string &dest) {
+    char buf[65536];
+    ssize_t n;
+    do {
+        n = read(fd, buf, sizeof(buf));
+    } while (n < 0 && errno == EINTR);
+    if (n > 0) {
+        dest.append(buf, static_cast<size_t>(n));
+        return;
+    }
+    close(fd);
+    fd = -1;
+}
+
+/**
+ * @brief Runs `args` to completion with stdout and stderr captured.
+ * @details Both pipes are read together, so a child that fills one of them
+ * cannot block. The wall time covers fork to reap, as in run().
+ */
+inline Result runCaptured(const std::vector<std::string> &args, std::string &out, std::string &err,
+                          const std::vector<std::string> &env = std::vector<std::string>()) {
+    Result result;
+    Child child;
+    if (!spawnCaptured(args, child, env))
+        return result;
+    while (child.outFd >= 0 || child.errFd >= 0) {
+        struct pollfd fds[2];
+        nfds_t count = 0;
+        if (child.outFd >= 0) {
+            fds[count].fd = child.outFd;
+            fds[count].events = POLLIN;
+            fds[count++].revents = 0;
+        }
+        if (child.errFd >= 0) {
+            fds[count].fd = child.errFd;
+            fds[count].events = POLLIN;
+            fds[count++].revents = 0;
+        }
+        if (poll(fds, count, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        for (nfds_t i = 0; i < count; ++i) {
+            if (fds[i].revents == 0)
+                continue;
+            if (fds[i].fd == child.outFd)
+                drain(child.outFd, out);
+            else
+                drain(child.errFd, err);
+        }
+    }
+    if (child.outFd >= 0)
+        close(child.outFd);
+    if (child.errFd >= 0)
+        close(child.errFd);
+    reap(child.pid, child.startSec, result);
+    return result;
+}
+
+} // namespace Subprocess
+
+#endif // SUBPROCESS_HPP
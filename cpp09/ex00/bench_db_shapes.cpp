@@ -0,0 +1,126 @@
+#include "BenchUtils.hpp"
+#include "BitcoinExchange.hpp"
+#include "BtcData.hpp"
+#include "gtest/gtest.h"
+#include <cstdio> // For remove()
+#include <fstream>
+#include <iomanip>
+
+// --- Database shape matrix for BitcoinExchange::loadDatabase ---
+// 同じ行数のDBを形を変えて生成し、loadDatabaseの読み込み速度 (rows/s, MB/s) を比べる。
+// 日付順・重複・行の長さはstd::mapへの挿入コスト (木の回転、ヒント挿入の当たり外れ、
+// 文字列の確保) を大きく変えるので、日次の昇順データだけでは分からない遅さが出る。
+//   daily      : 2009-01-02からの日次・昇順 (基準)
+//   sparse     : 0001-01-01〜9999-12-31にまばらに散らばる日付
+//   descending : 日付の降順
+//   duplicates : 半分の行が直前の行と同じ日付
+//   long rates : レートの小数部が200桁
+//   crlf       : 行末が "\r\n"
+// 読み込みを拒否した形 (例外) は "rejected" と表示し、失敗にはしない。
+//
+// 環境変数:
+//   BTC_SHAPE_SIZES  DBの行数リスト (default: 100000 1000000)
+//   BTC_SHAPE_REPEAT 1M行未満での繰り返し回数、中央値を採用 (default: 3)
+
+namespace {
+
+const char *kDbFile = "bench_shape_data.csv";
+
+struct Shape {
+    const char *name;
+    BtcData::DbSpec spec;
+};
+
+std::vector<Shape> shapes(size_t rows) {
+    std::vector<Shape> list;
+    Shape daily = {"daily", BtcData::DbSpec(rows)};
+    list.push_back(daily);
+
+    // 平均の間隔を (カレンダーの日数 / 行数) 程度にして、暦の端まで使い切る
+    const long span = BtcData::kMaxDay - BtcData::kMinDay;
+    const long widest = static_cast<long>(2 * span / static_cast<long>(rows ? rows : 1)) - 2;
+    Shape sparse = {"sparse", BtcData::DbSpec(rows, 42, BtcData::GapSpec(BtcData::GapSpec::UNIFORM, 1,
+                                                                        widest > 1 ? widest : 1),
+                                              BtcData::kMinDay)};
+    list.push_back(sparse);
+
+    Shape descending = {"descending", BtcData::DbSpec(rows)};
+    descending.spec.descending = true;
+    list.push_back(descending);
+
+    Shape duplicates = {"duplicates", BtcData::DbSpec(rows)};
+    duplicates.spec.duplicates = 0.5;
+    list.push_back(duplicates);
+
+    Shape longRates = {"long rates", BtcData::DbSpec(rows)};
+    longRates.spec.rateDigits = 200;
+    list.push_back(longRates);
+
+    Shape crlf = {"crlf", BtcData::DbSpec(rows)};
+    crlf.spec.crlf = true;
+    list.push_back(crlf);
+    return list;
+}
+
+size_t fileSize(const char *path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    return f ? static_cast<size_t>(f.tellg()) : 0;
+}
+
+} // namespace
+
+TEST(BitcoinExchangeBench, DatabaseShapes) {
+    std::vector<size_t> defaults;
+    defaults.push_back(100000);
+    defaults.push_back(1000000);
+    const std::vector<size_t> sizes = BenchUtils::envSizes("BTC_SHAPE_SIZES", defaults);
+    const size_t repeatSmall = BenchUtils::envSize("BTC_SHAPE_REPEAT", 3);
+
+    std::cout << "loadDatabase throughput by database shape" << std::endl;
+    std::cout << std::left << std::setw(10) << "DB rows" << " | " << std::setw(12) << "shape" << " | "
+              << std::setw(10) << "MB" << " | " << std::setw(10) << "load ms" << " | " << std::setw(12)
+              << "rows/s" << " | " << std::setw(8) << "MB/s" << " | " << "vs daily" << std::endl;
+
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        const size_t rows = sizes[i];
+        const size_t repeat = rows >= 1000000 ? 1 : repeatSmall;
+        const std::vector<Shape> list = shapes(rows);
+        double dailyNs = 0;
+        for (size_t s = 0; s < list.size(); ++s) {
+            BtcData::writeDatabase(kDbFile, list[s].spec);
+            const double mb = static_cast<double>(fileSize(kDbFile)) / 1e6;
+
+            std::vector<double> samples;
+            std::string rejected;
+            for (size_t r = 0; r < repeat && rejected.empty(); ++r) {
+                BitcoinExchange btc;
+                BenchUtils::SilenceStdStreams silence;
+                BenchUtils::Stopwatch sw;
+                try {
+                    btc.loadDatabase(kDbFile);
+                } catch (const std::exception &e) {
+                    rejected = e.what();
+                }
+                samples.push_back(sw.elapsedNs());
+            }
+
+            std::cout << std::left << std::setw(10) << rows << " | " << std::setw(12) << list[s].name << " | "
+                      << std::fixed << std::setprecision(1) << std::setw(10) << mb << " | ";
+            if (!rejected.empty()) {
+                std::cout << "rejected (" << rejected << ")" << std::endl;
+                std::cout.unsetf(std::ios::floatfield);
+                continue;
+            }
+            const double ns = BenchUtils::median(samples);
+            if (s == 0)
+                dailyNs = ns;
+            std::cout << std::setw(10) << ns / 1e6 << " | " << std::setprecision(0) << std::setw(12)
+                      << static_cast<double>(rows) / (ns / 1e9) << " | " << std::setprecision(1) << std::setw(8)
+                      << mb / (ns / 1e9) << " | " << std::setprecision(2) << (dailyNs > 0 ? ns / dailyNs : 0.0)
+                      << std::endl;
+            std::cout.unsetf(std::ios::floatfield);
+        }
+    }
+    std::cout << "Note: 'vs daily' > 1 means the shape loads slower than the sorted daily history." << std::endl;
+    std::remove(kDbFile);
+}
@@ -0,0 +1,133 @@
+#include "BenchUtils.hpp"
+#include "BitcoinExchange.hpp"
+#include "BtcData.hpp"
+#include "gtest/gtest.h"
+#include <cmath>  // For log2
+#include <cstdio> // For remove()
+#include <iomanip>
+
+// --- Lookup latency benchmark for BitcoinExchange ---
+// DBを一度だけloadDatabaseし、processInputFile経由で1行1検索の入力を流して
+// 1検索あたりのナノ秒を測る。プロセス起動・DB読み込み・出力先の影響を除くため、
+// ヘッダだけの入力ファイルの時間を差し引き、出力はCountingBufに捨てる。
+//
+// 環境変数:
+//   BTC_BENCH_SIZES   DBの行数リスト (default: 1000 10000 100000 1000000 10000000)
+//   BTC_BENCH_LOOKUPS 1種類あたりの検索行数 (default: 20000)
+//   BTC_BENCH_REPEAT  各計測の繰り返し回数、中央値を採用 (default: 5)
+//   BENCH_SAMPLES     "lookup_closest <distinct> <ns>" を追記するファイル (complexity_fit用)
+
+namespace {
+
+const char *kDbFile = "bench_lookup_data.csv";
+const long kGap = 2; // 1日おきの行にして、間の日付を「直前の日付」検索に使う
+
+enum QueryKind { EXACT_HIT, CLOSEST_PAST, BEFORE_FIRST };
+
+// 種類ごとの入力ファイルを作る (乱択はLCGで固定、毎回同じ日付列になる)
+void writeQueries(const std::string &path, QueryKind kind, size_t lookups, size_t distinct) {
+    BtcData::BufferedFile out(path);
+    out.write("date | value\n");
+    unsigned long long state = 42;
+    for (size_t i = 0; i < lookups; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t row = static_cast<size_t>((state >> 33) % distinct);
+        long day;
+        if (kind == EXACT_HIT)
+            day = BtcData::kDefaultStartDay + static_cast<long>(row) * kGap;
+        else if (kind == CLOSEST_PAST)
+            day = BtcData::kDefaultStartDay + static_cast<long>(row) * kGap + 1;
+        else
+            day = BtcData::kDefaultStartDay - 1 - static_cast<long>(row % 3650);
+        char *p = out.reserve(32);
+        p = BtcData::formatDate(p, day);
+        const char tail[] = " | 1\n";
+        for (size_t k = 0; k + 1 < sizeof(tail); ++k)
+            *p++ = tail[k];
+        out.commit(p);
+    }
+}
+
+// processInputFileを1回実行した時間(ns)。出力行数も返す
+double timeProcess(BitcoinExchange &btc, const std::string &path, size_t &outLines, size_t &errLines) {
+    BenchUtils::SilenceStdStreams silence;
+    BenchUtils::Stopwatch sw;
+    btc.processInputFile(path);
+    double ns = sw.elapsedNs();
+    outLines = silence.out.lines();
+    errLines = silence.err.lines();
+    return ns;
+}
+
+double medianProcessNs(BitcoinExchange &btc, const std::string &path, size_t repeat, size_t &outLines,
+                       size_t &errLines) {
+    std::vector<double> samples;
+    for (size_t r = 0; r < repeat; ++r)
+        samples.push_back(timeProcess(btc, path, outLines, errLines));
+    return BenchUtils::median(samples);
+}
+
+} // namespace
+
+TEST(BitcoinExchangeBench, LookupLatency) {
+    std::vector<size_t> defaults;
+    defaults.push_back(1000);
+    defaults.push_back(10000);
+    defaults.push_back(100000);
+    defaults.push_back(1000000);
+    defaults.push_back(10000000);
+    const std::vector<size_t> sizes = BenchUtils::envSizes("BTC_BENCH_SIZES", defaults);
+    const size_t lookups = BenchUtils::envSize("BTC_BENCH_LOOKUPS", 20000);
+    const size_t repeat = BenchUtils::envSize("BTC_BENCH_REPEAT", 5);
+    const size_t capacity = BtcData::calendarCapacity(BtcData::kDefaultStartDay, kGap);
+
+    const char *names[] = {"bench_lookup_exact.txt", "bench_lookup_closest.txt", "bench_lookup_miss.txt"};
+    const char *emptyName = "bench_lookup_empty.txt";
+    writeQueries(emptyName, EXACT_HIT, 0, 1);
+
+    std::cout << "Lookup latency through processInputFile (" << lookups << " lookups per kind, median of " << repeat
+              << ")" << std::endl;
+    std::cout << std::left << std::setw(10) << "DB rows" << " | " << std::setw(10) << "distinct" << " | "
+              << std::setw(12) << "exact ns" << " | " << std::setw(12) << "closest ns" << " | " << std::setw(12)
+              << "miss ns" << " | " << "closest ns/log2(N)" << std::endl;
+
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        const size_t rows = sizes[i];
+        const size_t distinct = rows < capacity ? rows : capacity;
+        BtcData::writeDatabase(kDbFile, BtcData::DbSpec(rows, 42, BtcData::GapSpec(BtcData::GapSpec::FIXED, kGap, kGap)));
+
+        BitcoinExchange btc;
+        ASSERT_NO_THROW(btc.loadDatabase(kDbFile));
+
+        size_t outLines, errLines;
+        const double baseNs = medianProcessNs(btc, emptyName, repeat, outLines, errLines);
+        double perLookup[3];
+        for (int kind = EXACT_HIT; kind <= BEFORE_FIRST; ++kind) {
+            writeQueries(names[kind], static_cast<QueryKind>(kind), lookups, distinct);
+            const double ns = medianProcessNs(btc, names[kind], repeat, outLines, errLines);
+            perLookup[kind] = (ns - baseNs) / static_cast<double>(lookups);
+            // 検索結果が期待したストリームに出ているか (計測対象を取り違えていないか) を確認
+            if (kind == BEFORE_FIRST) {
+                EXPECT_EQ(errLines, lookups) << names[kind];
+            } else {
+                EXPECT_EQ(outLines, lookups) << names[kind];
+            }
+        }
+
+        std::cout << std::left << std::setw(10) << rows << " | " << std::setw(10) << distinct << " | "
+                  << std::fixed << std::setprecision(1) << std::setw(12) << perLookup[EXACT_HIT] << " | "
+                  << std::setw(12) << perLookup[CLOSEST_PAST] << " | " << std::setw(12) << perLookup[BEFORE_FIRST]
+                  << " | " << perLookup[CLOSEST_PAST] / std::log2(static_cast<double>(distinct) + 1) << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+        BenchUtils::recordSample("lookup_closest", distinct, perLookup[CLOSEST_PAST]);
+    }
+    if (sizes.back() > capacity) {
+        std::cout << "Note: only " << capacity << " distinct dates fit before 9999-12-31;"
+                  << " larger databases repeat dates." << std::endl;
+    }
+
+    std::remove(kDbFile);
+    std::remove(emptyName);
+    for (int kind = EXACT_HIT; kind <= BEFORE_FIRST; ++kind)
+        std::remove(names[kind]);
+}
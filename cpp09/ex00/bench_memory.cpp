@@ -0,0 +1,69 @@
+#include "AllocCounter.hpp"
+#include "BenchUtils.hpp"
+#include "BitcoinExchange.hpp"
+#include "BtcData.hpp"
+#include "gtest/gtest.h"
+#include <cstdio> // For remove()
+#include <fstream>
+#include <iomanip>
+
+// --- Heap usage of BitcoinExchange::loadDatabase ---
+// AllocCounter.cppのoperator newを通して、loadDatabase中のヒープ確保を数え、
+// DB 1行あたりのバイト数を出す。std::map<std::string, double>では
+// 1行ごとにノードと文字列を確保するので、CSVの何倍にもなる。
+//
+// 環境変数:
+//   BTC_MEMORY_SIZES   DBの行数リスト (default: 1000 10000 100000 1000000)
+//   BENCH_COUNT_ALLOCS 1でヒープ確保を数える (未設定ならスキップ)
+
+namespace {
+
+const char *kDbFile = "bench_memory_data.csv";
+
+size_t fileSize(const char *path) {
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    return f ? static_cast<size_t>(f.tellg()) : 0;
+}
+
+} // namespace
+
+TEST(BitcoinExchangeBench, LoadDatabaseMemory) {
+    if (!AllocCounter::enabled())
+        GTEST_SKIP() << "Set BENCH_COUNT_ALLOCS=1 to count heap allocations";
+    std::vector<size_t> defaults;
+    defaults.push_back(1000);
+    defaults.push_back(10000);
+    defaults.push_back(100000);
+    defaults.push_back(1000000);
+    const std::vector<size_t> sizes = BenchUtils::envSizes("BTC_MEMORY_SIZES", defaults);
+
+    std::cout << "Heap usage of loadDatabase (bytes per DB row)" << std::endl;
+    std::cout << std::left << std::setw(10) << "DB rows" << " | " << std::setw(12) << "CSV bytes" << " | "
+              << std::setw(10) << "allocs/row" << " | " << std::setw(12) << "retained/row" << " | " << std::setw(12)
+              << "peak/row" << " | " << std::setw(12) << "retained MiB" << " | " << "x CSV" << std::endl;
+
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        const size_t rows = sizes[i];
+        BtcData::writeDatabase(kDbFile, BtcData::DbSpec(rows));
+        const size_t csvBytes = fileSize(kDbFile);
+
+        BitcoinExchange *btc = new BitcoinExchange;
+        AllocCounter::Scope scope;
+        ASSERT_NO_THROW(btc->loadDatabase(kDbFile));
+        const double n = static_cast<double>(rows);
+        const size_t retained = scope.retainedBytes();
+        const size_t allocations = scope.allocations();
+        const size_t peak = scope.peakBytes();
+        delete btc;
+
+        std::cout << std::left << std::setw(10) << rows << " | " << std::setw(12) << csvBytes << " | " << std::fixed
+                  << std::setprecision(2) << std::setw(10) << allocations / n << " | " << std::setprecision(1)
+                  << std::setw(12) << retained / n << " | " << std::setw(12) << peak / n << " | " << std::setw(12)
+                  << retained / (1024.0 * 1024.0) << " | " << std::setprecision(2)
+                  << static_cast<double>(retained) / static_cast<double>(csvBytes) << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    std::cout << "Note: bytes are the sizes requested from operator new; malloc adds its own overhead per block."
+              << std::endl;
+    std::remove(kDbFile);
+}
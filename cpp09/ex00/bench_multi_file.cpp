@@ -0,0 +1,122 @@
+#include "BenchUtils.hpp"
+#include "BitcoinExchange.hpp"
+#include "BtcData.hpp"
+#include "gtest/gtest.h"
+#include <algorithm> // For sort
+#include <cstdio> // For remove(), snprintf()
+#include <iomanip>
+#include <sys/stat.h> // For mkdir()
+#include <unistd.h>   // For rmdir()
+
+// --- Amortized multi-file benchmark for BitcoinExchange ---
+// DBを1回だけloadDatabaseし、同じインスタンスで多数の入力ファイルを
+// processInputFileに流して、1ファイルあたりのコストを測る。
+// 呼び出しごとにmapをコピーしたり線形に探したりする実装では、1ファイルの時間が
+// DBの行数に比例して増えるので、最小のDBとの比 (vs smallest) が大きくなる。
+// 呼び出しごとにdata.csvのような固定のファイルを読み直す実装は、どのDBでも同じだけ遅くなるので
+// 比には出ない。こちらは1行あたりの時間の上限 (BTC_MULTI_MAX_LINE_NS) で見る。
+// 前半と後半のファイルの時間比 (drift) で、呼び出しを重ねるごとに遅くなる実装も分かる。
+//
+// 環境変数:
+//   BTC_MULTI_DB_SIZES  DBの行数リスト、小さい順に実行する (default: 10000 100000 1000000)
+//   BTC_MULTI_FILES     入力ファイルの数 (default: 1000)
+//   BTC_MULTI_LINES     1ファイルの行数 (default: 100)
+//   BTC_MULTI_MAX_RATIO 最小のDBに対する1ファイルの時間の許容比 (default: 4)
+//   BTC_MULTI_MAX_LINE_NS 1行あたりの時間の上限 (ns, default: 10000)
+
+namespace {
+
+const char *kDbFile = "bench_multi_data.csv";
+const char *kInputDir = "bench_multi_inputs";
+
+std::string inputPath(size_t i) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "/input_%04zu.txt", i);
+    return kInputDir + std::string(name);
+}
+
+double mean(const std::vector<double> &v, size_t from, size_t to) {
+    double sum = 0;
+    for (size_t i = from; i < to; ++i)
+        sum += v[i];
+    return to > from ? sum / static_cast<double>(to - from) : 0.0;
+}
+
+} // namespace
+
+TEST(BitcoinExchangeBench, AmortizedMultiFile) {
+    std::vector<size_t> defaults;
+    defaults.push_back(10000);
+    defaults.push_back(100000);
+    defaults.push_back(1000000);
+    // 最初の行が最小のDBになるように並べる (vs smallest の基準)
+    std::vector<size_t> sizes = BenchUtils::envSizes("BTC_MULTI_DB_SIZES", defaults);
+    std::sort(sizes.begin(), sizes.end());
+    const size_t files = BenchUtils::envSize("BTC_MULTI_FILES", 1000);
+    const size_t lines = BenchUtils::envSize("BTC_MULTI_LINES", 100);
+    const double maxRatio = static_cast<double>(BenchUtils::envSize("BTC_MULTI_MAX_RATIO", 4));
+    const double maxLineNs = static_cast<double>(BenchUtils::envSize("BTC_MULTI_MAX_LINE_NS", 10000));
+    ASSERT_GT(files, 0u);
+
+    // 入力の日付は最小のDBの範囲に収め、どのDBでも同じファイルを使う
+    mkdir(kInputDir, 0755);
+    const long span = static_cast<long>(sizes[0]);
+    for (size_t i = 0; i < files; ++i)
+        BtcData::writeInput(inputPath(i), BtcData::InputSpec(lines, 1000 + i, BtcData::kDefaultStartDay, span));
+
+    std::cout << "processInputFile over " << files << " files of " << lines << " lines on one instance"
+              << std::endl;
+    std::cout << std::left << std::setw(10) << "DB rows" << " | " << std::setw(10) << "load ms" << " | "
+              << std::setw(12) << "per-file us" << " | " << std::setw(12) << "per-line ns" << " | "
+              << std::setw(8) << "drift" << " | " << "vs smallest" << std::endl;
+
+    double baseline = 0;
+    for (size_t s = 0; s < sizes.size(); ++s) {
+        const size_t rows = sizes[s];
+        BtcData::writeDatabase(kDbFile, BtcData::DbSpec(rows));
+
+        BitcoinExchange btc;
+        BenchUtils::Stopwatch load;
+        ASSERT_NO_THROW(btc.loadDatabase(kDbFile));
+        const double loadNs = load.elapsedNs();
+
+        std::vector<double> perFile(files);
+        size_t badFiles = 0;
+        for (size_t i = 0; i < files; ++i) {
+            BenchUtils::SilenceStdStreams silence;
+            BenchUtils::Stopwatch sw;
+            btc.processInputFile(inputPath(i));
+            perFile[i] = sw.elapsedNs();
+            // 全行が有効なクエリなので、1ファイルにつきlines行の結果が出るはず
+            badFiles += silence.out.lines() != lines;
+        }
+        EXPECT_EQ(badFiles, 0u) << rows << "-row DB: files with a wrong number of result lines";
+
+        const double medianNs = BenchUtils::median(perFile);
+        const size_t tenth = files >= 10 ? files / 10 : 1;
+        const double drift = mean(perFile, files - tenth, files) / mean(perFile, 0, tenth);
+        if (s == 0)
+            baseline = medianNs;
+        const double ratio = medianNs / baseline;
+
+        std::cout << std::left << std::setw(10) << rows << " | " << std::fixed << std::setprecision(1)
+                  << std::setw(10) << loadNs / 1e6 << " | " << std::setw(12) << medianNs / 1e3 << " | "
+                  << std::setw(12) << medianNs / static_cast<double>(lines ? lines : 1) << " | "
+                  << std::setprecision(2) << std::setw(8) << drift << " | " << ratio << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+
+        // 検索はO(log N)なので、DBが100倍になっても1ファイルの時間はほとんど変わらない
+        EXPECT_LT(ratio, maxRatio) << rows << "-row DB: per-file time grows with the DB size"
+                                   << " (is the database copied or searched linearly on every call?)";
+        // 1行の検索と出力は数us以内。1600行ほどのdata.csvでも、毎回読み直すと1行あたり10us以上増える
+        const double lineNs = medianNs / static_cast<double>(lines ? lines : 1);
+        EXPECT_LT(lineNs, maxLineNs) << rows << "-row DB: " << lineNs << " ns per line, over BTC_MULTI_MAX_LINE_NS"
+                                     << " (is a database file such as data.csv read again on every call?)";
+    }
+    std::cout << "Note: drift = mean of the last 10% of files / mean of the first 10%." << std::endl;
+
+    std::remove(kDbFile);
+    for (size_t i = 0; i < files; ++i)
+        std::remove(inputPath(i).c_str());
+    rmdir(kInputDir);
+}
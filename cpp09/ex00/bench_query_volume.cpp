@@ -0,0 +1,97 @@
+#include "BenchUtils.hpp"
+#include "BitcoinExchange.hpp"
+#include "BtcData.hpp"
+#include "gtest/gtest.h"
+#include <cstdio> // For remove()
+#include <iomanip>
+
+// --- Query-volume scaling benchmark for BitcoinExchange ---
+// DBの大きさを固定し、入力ファイルの行数 (10k〜10M) を増やして
+// processInputFileのlines/secを測る。1行あたりの時間は次の差分で3つに分ける:
+//   parse  = (1行だけのDB, 出力の整形なし) - (ヘッダだけの入力)
+//   lookup = (大きいDB,    出力の整形なし) - (1行だけのDB, 出力の整形なし)
+//   format = (大きいDB,    出力の整形あり) - (大きいDB,    出力の整形なし)
+// 「整形なし」はstd::cout/std::cerrをbadbitにして、operator<<を素通りさせる。
+//
+// 環境変数:
+//   BTC_QUERY_SIZES   入力の行数リスト (default: 10000 100000 1000000 10000000)
+//   BTC_QUERY_DB_ROWS 大きいDBの行数 (default: 100000)
+//   BTC_QUERY_REPEAT  1M行未満での繰り返し回数、中央値を採用 (default: 3)
+
+namespace {
+
+const char *kBigDb = "bench_query_big.csv";
+const char *kTinyDb = "bench_query_tiny.csv";
+const char *kInput = "bench_query_input.txt";
+const char *kEmptyInput = "bench_query_empty.txt";
+
+double medianProcessNs(BitcoinExchange &btc, const std::string &path, bool skipFormatting, size_t repeat,
+                       size_t &outLines) {
+    std::vector<double> samples;
+    for (size_t r = 0; r < repeat; ++r) {
+        BenchUtils::SilenceStdStreams silence(skipFormatting);
+        BenchUtils::Stopwatch sw;
+        btc.processInputFile(path);
+        samples.push_back(sw.elapsedNs());
+        outLines = silence.out.lines();
+    }
+    return BenchUtils::median(samples);
+}
+
+} // namespace
+
+TEST(BitcoinExchangeBench, QueryVolume) {
+    std::vector<size_t> defaults;
+    defaults.push_back(10000);
+    defaults.push_back(100000);
+    defaults.push_back(1000000);
+    defaults.push_back(10000000);
+    const std::vector<size_t> sizes = BenchUtils::envSizes("BTC_QUERY_SIZES", defaults);
+    const size_t dbRows = BenchUtils::envSize("BTC_QUERY_DB_ROWS", 100000);
+    const size_t repeatSmall = BenchUtils::envSize("BTC_QUERY_REPEAT", 3);
+
+    // クエリの日付はDBの範囲内に収める (大きいDBは日次なので、dbRows日分)
+    BtcData::writeDatabase(kBigDb, BtcData::DbSpec(dbRows));
+    BtcData::writeDatabase(kTinyDb, BtcData::DbSpec(1));
+    BtcData::writeInput(kEmptyInput, BtcData::InputSpec(0));
+
+    BitcoinExchange big;
+    BitcoinExchange tiny;
+    ASSERT_NO_THROW(big.loadDatabase(kBigDb));
+    ASSERT_NO_THROW(tiny.loadDatabase(kTinyDb));
+
+    std::cout << "processInputFile throughput with a " << dbRows << "-row DB (ns per line)" << std::endl;
+    std::cout << std::left << std::setw(10) << "lines" << " | " << std::setw(12) << "lines/s" << " | "
+              << std::setw(10) << "parse" << " | " << std::setw(10) << "lookup" << " | " << std::setw(10)
+              << "format" << " | " << "total" << std::endl;
+
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        const size_t lines = sizes[i];
+        const size_t repeat = lines >= 1000000 ? 1 : repeatSmall;
+        BtcData::writeInput(kInput, BtcData::InputSpec(lines, 42, BtcData::kDefaultStartDay,
+                                                       static_cast<long>(dbRows)));
+
+        size_t outLines;
+        const double open = medianProcessNs(big, kEmptyInput, true, repeat, outLines);
+        const double tinyNoFmt = medianProcessNs(tiny, kInput, true, repeat, outLines);
+        const double bigNoFmt = medianProcessNs(big, kInput, true, repeat, outLines);
+        const double bigFull = medianProcessNs(big, kInput, false, repeat, outLines);
+        // 全行が有効なクエリなので、標準出力に1行ずつ結果が出るはず
+        EXPECT_EQ(outLines, lines);
+
+        const double n = static_cast<double>(lines);
+        std::cout << std::left << std::setw(10) << lines << " | " << std::fixed << std::setprecision(0)
+                  << std::setw(12) << n / ((bigFull - open) / 1e9) << " | " << std::setprecision(1)
+                  << std::setw(10) << (tinyNoFmt - open) / n << " | " << std::setw(10)
+                  << (bigNoFmt - tinyNoFmt) / n << " | " << std::setw(10) << (bigFull - bigNoFmt) / n << " | "
+                  << (bigFull - open) / n << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    std::cout << "Note: small negative parts are measurement noise; the split assumes output is written"
+              << " with std::cout / std::cerr." << std::endl;
+
+    std::remove(kBigDb);
+    std::remove(kTinyDb);
+    std::remove(kInput);
+    std::remove(kEmptyInput);
+}
@@ -0,0 +1,379 @@
+#include "BenchUtils.hpp"
+#include "BitcoinExchange.hpp"
+#include "BtcData.hpp"
+#include <cstdint>
+#include <cstdio>  // For remove(), snprintf()
+#include <cstdlib> // For atol
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/mman.h> // For memfd_create
+#endif
+#ifndef BTC_LIBFUZZER
+#include <algorithm>
+#include <csignal>
+#include <ctime>
+#include <dirent.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <sys/stat.h>
+#include <vector>
+#endif
+
+// --- Fuzz target for BitcoinExchange::processInputFile ---
+// 変異させた入力ファイルをメモリ上のファイル (memfd) に書き、同じプロセスの中で
+// processInputFileに渡す。btcをケースごとに起動するより数千倍速い。
+//
+// clangがある場合 (make ex00_fuzz で自動判定) は -fsanitize=fuzzer でlibFuzzerに
+// 組み込む。ない場合は下の組み込みドライバを使う: BitcoinExchange.cppだけを
+// gccの -fsanitize-coverage=trace-pc で計装し、新しいエッジを通った入力をコーパスに
+// 加える。どちらも同じ引数で起動できる:
+//   ex00_fuzz_app [-max_total_time=秒] [-runs=回数] [-max_len=バイト] [corpus_dir]
+// コーパスは ex00_fuzz/corpus に保存され、次回の実行に引き継がれる (コミットするのは seed_* だけ)。
+
+namespace {
+
+const char *kDbFile = "fuzz_data.csv";
+const size_t kDbRows = 1000;
+
+// DBは最初の1回だけ生成して読み込む (2009-01-02から1000日分)。
+BitcoinExchange &exchange() {
+    static BitcoinExchange *btc = NULL;
+    if (btc == NULL) {
+        BtcData::writeDatabase(kDbFile, BtcData::DbSpec(kDbRows));
+        btc = new BitcoinExchange;
+        btc->loadDatabase(kDbFile);
+        std::remove(kDbFile);
+    }
+    return *btc;
+}
+
+// 入力を置くファイル。Linuxではmemfd、それ以外では一時ファイル。
+class InputFile {
+  public:
+    InputFile() : _fd(-1), _unlink(false) {
+#ifdef __linux__
+        _fd = memfd_create("btc_fuzz_input", 0);
+        if (_fd >= 0) {
+            char path[64];
+            std::snprintf(path, sizeof(path), "/proc/self/fd/%d", _fd);
+            _path = path;
+            return;
+        }
+#endif
+        char path[] = "/tmp/btc_fuzz_input_XXXXXX";
+        _fd = mkstemp(path);
+        _path = path;
+        _unlink = true;
+    }
+    ~InputFile() {
+        if (_fd >= 0)
+            close(_fd);
+        if (_unlink)
+            unlink(_path.c_str());
+    }
+
+    const std::string &store(const uint8_t *data, size_t size) {
+        if (ftruncate(_fd, 0) == 0) {
+            size_t done = 0;
+            while (done < size) {
+                const ssize_t n = pwrite(_fd, data + done, size - done, static_cast<off_t>(done));
+                if (n <= 0)
+                    break;
+                done += static_cast<size_t>(n);
+            }
+        }
+        return _path;
+    }
+
+  private:
+    int _fd;
+    std::string _path;
+    bool _unlink;
+};
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    static InputFile input;
+    BitcoinExchange &btc = exchange();
+    const std::string &path = input.store(data, size);
+    BenchUtils::SilenceStdStreams silence;
+    try {
+        btc.processInputFile(path);
+    } catch (const std::exception &) {
+        // 入力ファイルのエラーを例外で報告する実装もあるので、例外自体は失敗としない。
+    }
+    return 0;
+}
+
+#ifndef BTC_LIBFUZZER
+
+// --- Built-in coverage-guided driver (used when clang is not available) ---
+
+namespace {
+
+const size_t kMapSize = 1 << 16;
+unsigned char g_edges[kMapSize];
+uintptr_t g_prevLocation = 0;
+bool g_newEdge = false;
+
+// 入力の組み立てに使う断片。日付・区切り・数値の境界を狙う。
+const char *kDictionary[] = {
+    "date | value\n", "2011-01-03", "2009-01-02", "9999-12-31", "0000-00-00", "2012-02-29", "2013-02-29",
+    " | ",            "|",          "\n",         "\r\n",       "-1",         "0",          "1000",
+    "1001",           "2147483648", "1e308",      ".5",         "0.",         "nan",        "inf",
+    "+",              "  ",         "\t",         "99999999999999999999999999999999",
+};
+const size_t kDictionarySize = sizeof(kDictionary) / sizeof(kDictionary[0]);
+
+struct Options {
+    double maxTotalTime;
+    size_t runs;
+    size_t maxLen;
+    std::string corpusDir;
+
+    Options() : maxTotalTime(30), runs(0), maxLen(1 << 20) {}
+};
+
+// クラッシュした入力を残すため、実行中の入力と保存先を覚えておく。
+const std::vector<uint8_t> *g_current = NULL;
+int g_crashFd = -1;
+
+void onCrash(int sig) {
+    if (g_current != NULL && g_crashFd >= 0) {
+        if (ftruncate(g_crashFd, 0) == 0 && !g_current->empty()) {
+            ssize_t ignored = write(g_crashFd, &(*g_current)[0], g_current->size());
+            (void)ignored;
+        }
+    }
+    const char msg[] = "==fuzz== crash, input saved to crash-input\n";
+    ssize_t ignored = write(STDERR_FILENO, msg, sizeof(msg) - 1);
+    (void)ignored;
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+bool parseOptions(int argc, char **argv, Options &opt) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg.compare(0, 16, "-max_total_time=") == 0)
+            opt.maxTotalTime = std::atof(arg.c_str() + 16);
+        else if (arg.compare(0, 6, "-runs=") == 0)
+            opt.runs = static_cast<size_t>(std::atol(arg.c_str() + 6));
+        else if (arg.compare(0, 9, "-max_len=") == 0)
+            opt.maxLen = static_cast<size_t>(std::atol(arg.c_str() + 9));
+        else if (arg[0] != '-' && opt.corpusDir.empty())
+            opt.corpusDir = arg;
+        else
+            return false;
+    }
+    return opt.maxLen > 0;
+}
+
+std::vector<std::vector<uint8_t> > loadCorpus(const std::string &dir) {
+    std::vector<std::vector<uint8_t> > corpus;
+    DIR *d = opendir(dir.c_str());
+    if (d == NULL)
+        return corpus;
+    std::vector<std::string> names;
+    for (struct dirent *e; (e = readdir(d)) != NULL;) {
+        if (e->d_name[0] != '.')
+            names.push_back(e->d_name);
+    }
+    closedir(d);
+    std::sort(names.begin(), names.end());
+    for (size_t i = 0; i < names.size(); ++i) {
+        std::ifstream f((dir + "/" + names[i]).c_str(), std::ios::binary);
+        std::ostringstream content;
+        content << f.rdbuf();
+        const std::string s = content.str();
+        corpus.push_back(std::vector<uint8_t>(s.begin(), s.end()));
+    }
+    return corpus;
+}
+
+// FNV-1aの名前で保存するので、同じ入力は同じファイルになる。
+void saveInput(const std::string &dir, const std::vector<uint8_t> &data) {
+    unsigned long long h = 1469598103934665603ULL;
+    for (size_t i = 0; i < data.size(); ++i)
+        h = (h ^ data[i]) * 1099511628211ULL;
+    char name[32];
+    std::snprintf(name, sizeof(name), "/%016llx", h);
+    std::ofstream f((dir + name).c_str(), std::ios::binary);
+    if (!data.empty())
+        f.write(reinterpret_cast<const char *>(&data[0]), static_cast<std::streamsize>(data.size()));
+}
+
+size_t countEdges() {
+    size_t n = 0;
+    for (size_t i = 0; i < kMapSize; ++i)
+        n += g_edges[i] != 0;
+    return n;
+}
+
+// 1回の実行で新しいエッジを通ったか (このエッジマップはAFLと同じ prev ^ cur 方式)。
+bool runOne(const std::vector<uint8_t> &data) {
+    g_prevLocation = 0;
+    g_newEdge = false;
+    LLVMFuzzerTestOneInput(data.empty() ? NULL : &data[0], data.size());
+    return g_newEdge;
+}
+
+void mutate(std::vector<uint8_t> &data, const std::vector<std::vector<uint8_t> > &corpus, BtcData::Rng &rng,
+            size_t maxLen) {
+    const int stacked = 1 + static_cast<int>(rng.range(0, 3));
+    for (int m = 0; m < stacked; ++m) {
+        const size_t size = data.size();
+        switch (rng.range(0, 7)) {
+        case 0: // ビット反転
+            if (size > 0)
+                data[rng.range(0, size - 1)] ^= static_cast<uint8_t>(1u << rng.range(0, 7));
+            break;
+        case 1: { // 区切りや数字になりやすいバイトで上書き
+            static const char kBytes[] = "|-. 0123456789e+\n\r\0";
+            if (size > 0)
+                data[rng.range(0, size - 1)] = static_cast<uint8_t>(kBytes[rng.range(0, sizeof(kBytes) - 1)]);
+            break;
+        }
+        case 2: { // 辞書の断片を挿入
+            const char *token = kDictionary[rng.range(0, kDictionarySize - 1)];
+            data.insert(data.begin() + static_cast<long>(rng.range(0, size)), token, token + std::strlen(token));
+            break;
+        }
+        case 3: { // NULバイトを挿入
+            data.insert(data.begin() + static_cast<long>(rng.range(0, size)), static_cast<uint8_t>(0));
+            break;
+        }
+        case 4: // 範囲を削除
+            if (size > 1) {
+                const size_t from = rng.range(0, size - 1);
+                const size_t len = rng.range(1, std::min<size_t>(size - from, 64));
+                data.erase(data.begin() + static_cast<long>(from), data.begin() + static_cast<long>(from + len));
+            }
+            break;
+        case 5: // 範囲を複製
+            if (size > 0) {
+                const size_t from = rng.range(0, size - 1);
+                const size_t len = rng.range(1, std::min<size_t>(size - from, 256));
+                const std::vector<uint8_t> chunk(data.begin() + static_cast<long>(from),
+                                                 data.begin() + static_cast<long>(from + len));
+                data.insert(data.begin() + static_cast<long>(rng.range(0, size)), chunk.begin(), chunk.end());
+            }
+            break;
+        case 6: { // 別のコーパス要素と継ぎ合わせ
+            const std::vector<uint8_t> &other = corpus[rng.range(0, corpus.size() - 1)];
+            const size_t cut = size == 0 ? 0 : rng.range(0, size);
+            const size_t from = other.empty() ? 0 : rng.range(0, other.size());
+            data.resize(cut);
+            data.insert(data.end(), other.begin() + static_cast<long>(from), other.end());
+            break;
+        }
+        default: // 1つの桁や文字を長く伸ばし、巨大な数値・巨大な行を作る
+            if (size > 0 && rng.range(0, 15) == 0) {
+                const size_t at = rng.range(0, size - 1);
+                const size_t len = static_cast<size_t>(1) << rng.range(4, 20);
+                data.insert(data.begin() + static_cast<long>(at), len, data[at]);
+            }
+            break;
+        }
+    }
+    if (data.size() > maxLen)
+        data.resize(maxLen);
+}
+
+} // namespace
+
+// gccの -fsanitize-coverage=trace-pc は計装した各基本ブロックでこの関数を呼ぶ。
+extern "C" void __sanitizer_cov_trace_pc() {
+    const uintptr_t pc = reinterpret_cast<uintptr_t>(__builtin_return_address(0));
+    const uintptr_t location = (pc ^ (pc >> 16)) & (kMapSize - 1);
+    unsigned char &edge = g_edges[location ^ g_prevLocation];
+    if (edge == 0) {
+        edge = 1;
+        g_newEdge = true;
+    }
+    g_prevLocation = location >> 1;
+}
+
+int main(int argc, char **argv) {
+    Options opt;
+    if (!parseOptions(argc, argv, opt)) {
+        std::cerr << "Usage: " << argv[0] << " [-max_total_time=N] [-runs=N] [-max_len=N] [corpus_dir]" << std::endl;
+        return 2;
+    }
+    std::vector<std::vector<uint8_t> > corpus;
+    if (!opt.corpusDir.empty()) {
+        mkdir(opt.corpusDir.c_str(), 0755);
+        corpus = loadCorpus(opt.corpusDir);
+    }
+    if (corpus.empty())
+        corpus.push_back(std::vector<uint8_t>());
+
+    g_crashFd = open("crash-input", O_WRONLY | O_CREAT, 0644);
+    signal(SIGSEGV, onCrash);
+    signal(SIGABRT, onCrash);
+    signal(SIGFPE, onCrash);
+    signal(SIGBUS, onCrash);
+
+    exchange();
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        g_current = &corpus[i];
+        runOne(corpus[i]);
+    }
+    std::cout << "#" << corpus.size() << " INITED cov: " << countEdges() << " corpus: " << corpus.size() << std::endl;
+
+    BtcData::Rng rng(static_cast<unsigned long long>(std::time(NULL)) ^ static_cast<unsigned long long>(getpid()));
+    BenchUtils::Stopwatch total;
+    size_t execs = 0, added = 0, slowestSize = 0;
+    double slowestNs = 0, nextReport = 1;
+    std::vector<uint8_t> input, slowest;
+    while ((opt.runs == 0 || execs < opt.runs) && total.elapsedSec() < opt.maxTotalTime) {
+        input = corpus[rng.range(0, corpus.size() - 1)];
+        mutate(input, corpus, rng, opt.maxLen);
+        g_current = &input;
+        BenchUtils::Stopwatch one;
+        const bool interesting = runOne(input);
+        const double ns = one.elapsedNs();
+        ++execs;
+        if (ns > slowestNs) {
+            slowestNs = ns;
+            slowest = input;
+            slowestSize = input.size();
+        }
+        if (interesting) {
+            corpus.push_back(input);
+            ++added;
+            if (!opt.corpusDir.empty())
+                saveInput(opt.corpusDir, input);
+        }
+        if (total.elapsedSec() >= nextReport) {
+            std::cout << "#" << execs << " cov: " << countEdges() << " corpus: " << corpus.size()
+                      << " exec/s: " << static_cast<size_t>(execs / total.elapsedSec()) << std::endl;
+            nextReport *= 2;
+        }
+    }
+    g_current = NULL;
+    close(g_crashFd);
+    unlink("crash-input");
+
+    const double sec = total.elapsedSec();
+    std::cout << "Done " << execs << " runs in " << std::fixed << std::setprecision(1) << sec
+              << "s: exec/s: " << static_cast<size_t>(sec > 0 ? execs / sec : 0) << ", cov: " << countEdges()
+              << ", new corpus entries: " << added << std::endl;
+    std::cout << "Slowest input: " << slowestSize << " bytes, " << std::setprecision(3) << slowestNs / 1e6 << " ms";
+    if (!slowest.empty()) {
+        std::ofstream f("slowest-input", std::ios::binary);
+        f.write(reinterpret_cast<const char *>(&slowest[0]), static_cast<std::streamsize>(slowest.size()));
+        std::cout << " (saved to slowest-input)";
+    }
+    std::cout << std::endl;
+    return 0;
+}
+
+#endif // BTC_LIBFUZZER
@@ -13,12 +13,34 @@ NC='\033[0m' # No Color
 # --- Variables ---
 PRJ_DIR="../../../cpp09/ex00"
 EXECUTABLE="./$PRJ_DIR/btc"
-DB_GENERATOR="./generate_db.sh"
+DB_GENERATOR="../tools/btc_dbgen"
+# Runs a program and reports "<elapsed_seconds> <max_rss_kib> <exit_status>" (built by 'make tools')
+MEASURE="../tools/measure"
+MEASURE_REPORT="measure.log"
 INPUT_FILE="input_perf.txt"
 DB_FILE="data.csv"
+# Generated databases are kept here and reused, keyed by size and seed
+# (ignored by git, removed by 'make fclean').
+# The same seed gives byte-identical databases on every machine.
+DB_CACHE_DIR="db_cache"
+DB_SEED=${DB_SEED:-42}
 
 # Array of database sizes to test
-TEST_SIZES=(1000 10000 100000 500000) # You can add more sizes like 1000000
+TEST_SIZES=(1000 10000 100000 500000 1000000) # You can add more sizes like 10000000
+
+# Query-volume scaling: input files of these many "date | value" lines are run
+# against one database of QUERY_DB_ROWS rows.
+QUERY_SIZES=(10000 100000 1000000 10000000)
+QUERY_DB_ROWS=100000
+# gtest-linked benchmark program (built by 'make ex00_bench')
+BENCH_APP="../ex00_bench_app"
+# LD_PRELOAD shim counting write(2)/writev(2) per file descriptor (built by 'make tools', Linux only)
+WRITE_AUDIT="../tools/write_audit.so"
+AUDIT_LINES=1000000
+AUDIT_LOG="write_audit.log"
+# Fits (size, time) samples against O(1) ... O(n^2) (built by 'make tools')
+COMPLEXITY_FIT="../tools/complexity_fit"
+SAMPLES_FILE="samples.txt"
 
 # --- Pre-flight Checks ---
 if [ ! -f "$EXECUTABLE" ]; then
@@ -27,8 +49,13 @@ if [ ! -f "$EXECUTABLE" ]; then
     exit 1
 fi
 if [ ! -x "$DB_GENERATOR" ]; then
-    echo -e "${RED}Error: Database generator '$DB_GENERATOR' is not executable.${NC}"
-    echo -e "${YELLOW}Please run 'chmod +x $DB_GENERATOR'.${NC}"
+    echo -e "${RED}Error: Database generator '$DB_GENERATOR' not found.${NC}"
+    echo -e "${YELLOW}Please build it first with 'make tools' in the cpp09 directory.${NC}"
+    exit 1
+fi
+if [ ! -x "$MEASURE" ] || [ ! -x "$COMPLEXITY_FIT" ]; then
+    echo -e "${RED}Error: '$MEASURE' or '$COMPLEXITY_FIT' not found.${NC}"
+    echo -e "${YELLOW}Please build them first with 'make tools' in the cpp09 directory.${NC}"
     exit 1
 fi
 if [ ! -f "$INPUT_FILE" ]; then
@@ -36,34 +63,175 @@ if [ ! -f "$INPUT_FILE" ]; then
     exit 1
 fi
 
+# --- Helper Functions ---
+# Cached files are generated under a .tmp name and moved into place only on success,
+# so an interrupted or failed run never leaves a truncated file that looks cached.
+
+# $1: Number of rows. Links data.csv to the cached database (generated if needed)
+#     and sets GEN_TIME to the generation time or "cached".
+link_db() {
+    local CACHED_DB="$DB_CACHE_DIR/data_${1}_s${DB_SEED}.csv"
+    if [ -f "$CACHED_DB" ]; then
+        GEN_TIME="cached"
+    else
+        mkdir -p "$DB_CACHE_DIR"
+        TIMEFORMAT="%3R"
+        if ! GEN_TIME="$( { time "$DB_GENERATOR" "$1" -s "$DB_SEED" -o "$CACHED_DB.tmp" 2> /dev/null; } 2>&1 )s"; then
+            rm -f "$CACHED_DB.tmp"
+            echo -e "${RED}Error: '$DB_GENERATOR' failed to generate a $1-row database.${NC}"
+            exit 1
+        fi
+        mv "$CACHED_DB.tmp" "$CACHED_DB"
+    fi
+    ln -sf "$CACHED_DB" "$DB_FILE"
+}
+
+# $1: Number of lines. Sets QUERY_FILE to the cached input file (generated if needed).
+prepare_queries() {
+    QUERY_FILE="$DB_CACHE_DIR/input_${1}_s${DB_SEED}.txt"
+    if [ ! -f "$QUERY_FILE" ]; then
+        mkdir -p "$DB_CACHE_DIR"
+        if ! "$DB_GENERATOR" "$1" -m input -s "$DB_SEED" -d "$QUERY_DB_ROWS" -o "$QUERY_FILE.tmp"; then
+            rm -f "$QUERY_FILE.tmp"
+            echo -e "${RED}Error: '$DB_GENERATOR' failed to generate a $1-line input file.${NC}"
+            exit 1
+        fi
+        mv "$QUERY_FILE.tmp" "$QUERY_FILE"
+    fi
+}
+
+# $@: Command. Runs it under $MEASURE and sets EXEC_TIME (seconds) and PEAK_RSS_KB.
+measure_run() {
+    "$MEASURE" -o "$MEASURE_REPORT" "$@"
+    read -r EXEC_TIME PEAK_RSS_KB _ < "$MEASURE_REPORT"
+    EXEC_TIME=$(awk -v t="$EXEC_TIME" 'BEGIN { printf "%.3f", t }')
+    rm -f "$MEASURE_REPORT"
+}
+
 # --- Test Execution ---
 echo -e "--- Running Performance Tests for BitcoinExchange ---"
 echo -e "This will measure the execution time for searching in databases of different sizes."
-echo "Note: Database generation may take a moment for larger sizes."
-echo "---------------------------------------------------------"
-printf "%-15s | %-20s | %-15s\n" "DB Rows (N)" "DB Generation Time" "BTC Exec Time"
-echo "---------------------------------------------------------"
+echo "Databases are generated once with seed $DB_SEED and cached in '$DB_CACHE_DIR'."
+echo "------------------------------------------------------------------------------"
+printf "%-15s | %-20s | %-15s | %-15s\n" "DB Rows (N)" "DB Generation Time" "BTC Exec Time" "Peak RSS"
+echo "------------------------------------------------------------------------------"
 
 for N in "${TEST_SIZES[@]}"; do
     printf "%-15s | " "$N"
 
-    # 1. Generate the database and measure generation time
-    # Use /usr/bin/time to get clean time output
-    GEN_TIME=$( (/usr/bin/time -f "%e" "$DB_GENERATOR" "$N" > "$DB_FILE") 2>&1 )
-    printf "%-20s | " "${GEN_TIME}s"
+    # 1. Generate the database (or reuse the cached one) and measure generation time
+    link_db "$N"
+    printf "%-20s | " "$GEN_TIME"
 
-    # 2. Run the btc program and measure its execution time
+    # 2. Run the btc program and measure its execution time and peak memory
     # We only care about the execution time of btc, not the output.
-    # The time command captures stderr, so we redirect it.
-    EXEC_TIME=$( (/usr/bin/time -f "%e" "$EXECUTABLE" "$INPUT_FILE" > /dev/null) 2>&1 )
-    printf "${CYAN}%-15s${NC}\n" "${EXEC_TIME}s"
+    measure_run "$EXECUTABLE" "$INPUT_FILE" > /dev/null 2>&1
+    printf "${CYAN}%-15s${NC} | %-15s\n" "${EXEC_TIME}s" "$((PEAK_RSS_KB / 1024)) MiB"
 done
 
 # --- Summary ---
-echo "---------------------------------------------------------"
+echo "------------------------------------------------------------------------------"
 echo -e "${GREEN}Test finished.${NC}"
-echo "Observe how the 'BTC Exec Time' does not grow linearly with 'DB Rows (N)'."
-echo "This demonstrates the O(log N) efficiency of the search algorithm."
+
+# --- Lookup Complexity ---
+# The exec time above includes loading the database, which is O(N) by nature.
+# The lookup alone is timed in-process and expected to be O(log N).
+FIT_STATUS=0
+if [ -x "$BENCH_APP" ]; then
+    echo ""
+    rm -f "$SAMPLES_FILE"
+    BENCH_SAMPLES="$SAMPLES_FILE" BTC_BENCH_SIZES="${TEST_SIZES[*]}" \
+        "$BENCH_APP" --gtest_filter=BitcoinExchangeBench.LookupLatency --gtest_brief=1
+    awk '$1 == "lookup_closest" { print $2, $3 }' "$SAMPLES_FILE" | "$COMPLEXITY_FIT" --expect logn
+    FIT_STATUS=$?
+    rm -f "$SAMPLES_FILE"
+else
+    echo -e "${YELLOW}Skip lookup complexity: '$BENCH_APP' not found (build it with 'make ex00_bench').${NC}"
+fi
+
+# --- Heap Usage of loadDatabase ---
+# Peak RSS above includes the whole process; the in-process count below only
+# covers what loadDatabase allocates, per database row. Heap counting is opt-in,
+# so the timing benchmarks above run on the plain allocator.
+if [ -x "$BENCH_APP" ]; then
+    echo ""
+    BENCH_COUNT_ALLOCS=1 BTC_MEMORY_SIZES="${TEST_SIZES[*]}" \
+        "$BENCH_APP" --gtest_filter=BitcoinExchangeBench.LoadDatabaseMemory --gtest_brief=1
+fi
+
+# --- Database Shapes ---
+# Sorted daily rows are the best case for std::map insertion; real exports can
+# be sparse, reversed, duplicated, long-valued or CRLF-terminated.
+if [ -x "$BENCH_APP" ]; then
+    echo ""
+    BTC_SHAPE_SIZES="100000 1000000" \
+        "$BENCH_APP" --gtest_filter=BitcoinExchangeBench.DatabaseShapes --gtest_brief=1
+fi
+
+# --- Amortized Multi-File Processing ---
+# One database, many query batches: the per-file cost must not depend on the
+# database size once it is loaded.
+if [ -x "$BENCH_APP" ]; then
+    echo ""
+    "$BENCH_APP" --gtest_filter=BitcoinExchangeBench.AmortizedMultiFile --gtest_brief=1
+fi
+
+# --- Query Volume Scaling ---
+# Programs that are fast on lookups but slow per line (a stringstream per line,
+# a flush per line) only show up when the number of queries grows.
+echo ""
+echo -e "--- Query Volume Scaling (DB: $QUERY_DB_ROWS rows) ---"
+echo "---------------------------------------------------------"
+printf "%-15s | %-15s | %-15s\n" "Input Lines" "BTC Exec Time" "Lines/sec"
+echo "---------------------------------------------------------"
+link_db "$QUERY_DB_ROWS"
+for Q in "${QUERY_SIZES[@]}"; do
+    prepare_queries "$Q"
+    measure_run "$EXECUTABLE" "$QUERY_FILE" > /dev/null 2>&1
+    LINES_PER_SEC=$(awk -v n="$Q" -v t="$EXEC_TIME" 'BEGIN { if (t > 0) printf "%.0f", n / t; else print "-" }')
+    printf "%-15s | ${CYAN}%-15s${NC} | %-15s\n" "$Q" "${EXEC_TIME}s" "$LINES_PER_SEC"
+done
+echo "---------------------------------------------------------"
+
+# In-process breakdown of processInputFile into parse / lookup / output formatting.
+if [ -x "$BENCH_APP" ]; then
+    echo "Per-line breakdown measured in-process (ex00_bench_app):"
+    BTC_QUERY_SIZES="${QUERY_SIZES[*]}" BTC_QUERY_DB_ROWS="$QUERY_DB_ROWS" \
+        "$BENCH_APP" --gtest_filter=BitcoinExchangeBench.QueryVolume --gtest_brief=1
+else
+    echo -e "${YELLOW}Skip per-line breakdown: '$BENCH_APP' not found (build it with 'make ex00_bench').${NC}"
+fi
+
+# --- write(2) Audit ---
+# A program that flushes every result (std::endl) makes one system call per
+# output line, which costs more than the lookup itself.
+echo ""
+echo -e "--- write(2) Audit ($AUDIT_LINES input lines) ---"
+if [ -f "$WRITE_AUDIT" ]; then
+    prepare_queries "$AUDIT_LINES"
+    rm -f "$AUDIT_LOG"
+    OUT_LINES=$(WRITE_AUDIT_LOG="$AUDIT_LOG" LD_PRELOAD="$WRITE_AUDIT" "$EXECUTABLE" "$QUERY_FILE" 2> /dev/null | wc -l)
+    echo "---------------------------------------------------------"
+    printf "%-8s | %-12s | %-8s | %-14s | %-15s\n" "FD" "write" "writev" "Bytes" "Syscalls/Line"
+    echo "---------------------------------------------------------"
+    awk -v lines="$OUT_LINES" -v cyan="$CYAN" -v nc="$NC" '
+        /mode=/ { mode = $2; sub("mode=", "", mode) }
+        /fd=/ {
+            for (i = 2; i <= NF; i++) { split($i, kv, "="); v[kv[1]] = kv[2] }
+            calls = v["write"] + v["writev"]
+            printf "%-8s | %-12s | %-8s | %-14s | %s%-15s%s\n", v["fd"], v["write"], v["writev"], v["bytes"],
+                   cyan, (lines > 0 ? sprintf("%.4f", calls / lines) : "-"), nc
+        }
+        END { if (mode == "interpose") print "Note: stdio-internal writes are not visible on this platform." }
+    ' "$AUDIT_LOG"
+    echo "---------------------------------------------------------"
+    echo "Output lines on stdout: $OUT_LINES (compare with the $AUDIT_LINES-line row of the table above)"
+    rm -f "$AUDIT_LOG"
+else
+    echo -e "${YELLOW}Skip write(2) audit: '$WRITE_AUDIT' not found (build it with 'make tools' on Linux).${NC}"
+fi
 
 # --- Cleanup ---
+# Only the link is removed; the cached databases are reused by the next run.
 rm -f "$DB_FILE"
+exit $FIT_STATUS
@@ -0,0 +1,166 @@
+#ifndef RPN_REFERENCE_HPP
+#define RPN_REFERENCE_HPP
+
+#include "BenchUtils.hpp"
+#include "RPN.hpp"
+#include <climits> // For INT_MAX, INT_MIN
+#include <cmath>   // For fabs
+#include <cstdlib> // For strtod
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @namespace RpnReference
+ * @brief Independent evaluator for the ex01 RPN language, used to check
+ * RPN::evaluate on generated expressions.
+ * @details The language: tokens separated by spaces, each a single digit 0-9
+ * or one of + - * /. Any other token, a missing or surplus operand, and a
+ * division by zero are errors. Intermediate values are exact in long long.
+ * @note Results that legitimately depend on the implementation's number type
+ * are reported as AMBIGUOUS and must not be compared: a value outside the int
+ * range (int implementations overflow) and a non-exact division (integer and
+ * floating-point implementations disagree).
+ */
+namespace RpnReference {
+
+enum Outcome { VALUE, ERROR, AMBIGUOUS };
+
+struct Result {
+    Outcome outcome;
+    long long value; // Meaningful for VALUE only
+
+    Result(Outcome o = ERROR, long long v = 0) : outcome(o), value(v) {}
+};
+
+inline Result evaluate(const std::string &expr) {
+    std::vector<long long> stack;
+    stack.reserve(16);
+    // Once a value is ambiguous the rest is only checked for structure:
+    // operand shortage and surplus do not depend on the values.
+    bool ambiguous = false;
+    size_t i = 0;
+    while (i < expr.size()) {
+        if (expr[i] == ' ') {
+            ++i;
+            continue;
+        }
+        if (i + 1 < expr.size() && expr[i + 1] != ' ')
+            return Result(ERROR); // Tokens are single characters
+        const char c = expr[i++];
+        if (c >= '0' && c <= '9') {
+            stack.push_back(c - '0');
+            continue;
+        }
+        if (c != '+' && c != '-' && c != '*' && c != '/')
+            return Result(ERROR);
+        if (stack.size() < 2)
+            return Result(ERROR);
+        const long long b = stack.back();
+        stack.pop_back();
+        const long long a = stack.back();
+        if (ambiguous)
+            continue;
+        long long r;
+        if (c == '+') {
+            r = a + b;
+        } else if (c == '-') {
+            r = a - b;
+        } else if (c == '*') {
+            r = a * b;
+        } else {
+            if (b == 0)
+                return Result(ERROR);
+            if (a % b != 0) {
+                ambiguous = true;
+                continue;
+            }
+            r = a / b;
+        }
+        if (r > INT_MAX || r < INT_MIN) {
+            ambiguous = true;
+            continue;
+        }
+        stack.back() = r;
+    }
+    if (stack.size() != 1)
+        return Result(ERROR);
+    return ambiguous ? Result(AMBIGUOUS) : Result(VALUE, stack.back());
+}
+
+/**
+ * @brief What RPN::evaluate did with one expression.
+ */
+struct Actual {
+    bool threw;
+    std::string output; // What evaluate wrote to std::cout
+};
+
+/**
+ * @brief Calls rpn.evaluate(expr) with std::cout captured into `buffer` and
+ * std::cerr discarded.
+ * @note The caller keeps the buffer so that it is reused between calls.
+ */
+inline Actual run(RPN &rpn, const std::string &expr, std::stringstream &buffer) {
+    Actual actual;
+    actual.threw = false;
+    buffer.str(std::string());
+    buffer.clear();
+    BenchUtils::CountingBuf discard;
+    std::streambuf *oldOut = std::cout.rdbuf(buffer.rdbuf());
+    std::streambuf *oldErr = std::cerr.rdbuf(&discard);
+    try {
+        rpn.evaluate(expr);
+    } catch (const std::exception &) {
+        actual.threw = true;
+    }
+    std::cout.rdbuf(oldOut);
+    std::cerr.rdbuf(oldErr);
+    actual.output = buffer.str();
+    return actual;
+}
+
+/**
+ * @brief True if `actual` agrees with `expected`; AMBIGUOUS agrees with anything.
+ * @details A value must be the only thing printed, as one number on one line.
+ * It is compared numerically, so "42" and "42.0" both match 42.
+ */
+inline bool matches(const Result &expected, const Actual &actual) {
+    if (expected.outcome == AMBIGUOUS)
+        return true;
+    if (expected.outcome == ERROR)
+        return actual.threw;
+    if (actual.threw || actual.output.empty() || actual.output[actual.output.size() - 1] != '\n')
+        return false;
+    const std::string text = actual.output.substr(0, actual.output.size() - 1);
+    char *end;
+    const double got = std::strtod(text.c_str(), &end);
+    if (text.empty() || *end != '\0')
+        return false;
+    const double want = static_cast<double>(expected.value);
+    const double scale = std::fabs(want) > 1 ? std::fabs(want) : 1;
+    return std::fabs(got - want) <= 1e-9 * scale;
+}
+
+inline std::string describe(const Result &r) {
+    if (r.outcome == ERROR)
+        return "error";
+    if (r.outcome == AMBIGUOUS)
+        return "ambiguous";
+    std::ostringstream oss;
+    oss << r.value;
+    return oss.str();
+}
+
+inline std::string describe(const Actual &a) {
+    if (a.threw)
+        return "exception";
+    std::string out = a.output;
+    if (!out.empty() && out[out.size() - 1] == '\n')
+        out.erase(out.size() - 1);
+    return "\"" + out + "\"";
+}
+
+} // namespace RpnReference
+
+#endif // RPN_REFERENCE_HPP
@@ -0,0 +1,178 @@
+#include "AllocCounter.hpp"
+#include "BenchUtils.hpp"
+#include "RPN.hpp"
+#include "gtest/gtest.h"
+#include <iomanip>
+#include <sstream>
+#include <sys/resource.h> // For getrusage
+
+// --- Throughput benchmark for RPN::evaluate ---
+// 式をメモリ上で組み立ててevaluateを直接呼ぶので、argvの1引数128KiB制限
+// (MAX_ARG_STRLEN) に関係なく、1M〜100Mトークンの式を測れる。
+// 式は "1 2 + 2 + 2 + ..." で、トークン数がそのまま計算結果になる。
+//
+// DeepStackProfileは "1 1 1 ... + + +" (generate_rpn.shのdeepモード) で、
+// N個のオペランドを全部積んでから演算するので、スタックの深さの最大値はNになる。
+// その間のヒープ確保をAllocCounterで数え、オペランド1個あたりのバイト数と確保回数を出す。
+// std::stack<long> (deque) なら数バイト・512バイトごとに1回、std::listなら
+// ノードごとに1回の確保になる。
+//
+// 環境変数:
+//   RPN_BENCH_SIZES  トークン数のリスト (default: 1000000 10000000 100000000)
+//   RPN_BENCH_REPEAT 10Mトークン未満での繰り返し回数、中央値を採用 (default: 3)
+//   RPN_DEEP_SIZES   DeepStackProfileのオペランド数 (default: 1000 100000 1000000 10000000)
+//   BENCH_SAMPLES    Throughputの "rpn_chain <tokens> <ns>" を追記するファイル (complexity_fit用)
+//   BENCH_COUNT_ALLOCS 1でヒープ確保を数える。未設定ならDeepStackProfileはスキップし、
+//                    Throughputのheap peakとallocsは "n/a" (時間はシステムのmallocのまま測る)
+
+namespace {
+
+// 1 + 2 * pairs トークンの式 ("1" と pairs個の " 2 +")
+std::string makeExpression(size_t tokens) {
+    const size_t pairs = tokens / 2;
+    std::string expr;
+    expr.reserve(1 + pairs * 4);
+    expr += '1';
+    for (size_t i = 0; i < pairs; ++i)
+        expr += " 2 +";
+    return expr;
+}
+
+// N個の "1" のあとにN-1個の "+" (結果はN)
+std::string makeDeepExpression(size_t operands) {
+    std::string expr;
+    expr.reserve(operands * 4);
+    expr += '1';
+    for (size_t i = 1; i < operands; ++i)
+        expr += " 1";
+    for (size_t i = 1; i < operands; ++i)
+        expr += " +";
+    return expr;
+}
+
+// BENCH_COUNT_ALLOCS がないときは数えていないので "n/a"
+std::string allocCell(double value, int precision) {
+    if (!AllocCounter::enabled())
+        return "n/a";
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(precision) << value;
+    return oss.str();
+}
+
+long peakRssKb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+} // namespace
+
+TEST(RPNBench, Throughput) {
+    std::vector<size_t> defaults;
+    defaults.push_back(1000000);
+    defaults.push_back(10000000);
+    defaults.push_back(100000000);
+    const std::vector<size_t> sizes = BenchUtils::envSizes("RPN_BENCH_SIZES", defaults);
+    const size_t repeatSmall = BenchUtils::envSize("RPN_BENCH_REPEAT", 3);
+
+    std::cout << "RPN::evaluate throughput on \"1 2 + 2 + ...\" (expression built in memory)" << std::endl;
+    std::cout << std::left << std::setw(12) << "tokens" << " | " << std::setw(10) << "expr MiB" << " | "
+              << std::setw(10) << "time ms" << " | " << std::setw(12) << "Mtokens/s" << " | " << std::setw(13)
+              << "heap peak MiB" << " | " << std::setw(10) << "allocs" << " | " << "process RSS MiB" << std::endl;
+
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        const size_t tokens = sizes[i] | 1; // 奇数トークンにそろえる
+        const size_t repeat = tokens >= 10000000 ? 1 : repeatSmall;
+        const std::string expr = makeExpression(tokens);
+        std::ostringstream expected;
+        expected << tokens << "\n";
+
+        std::vector<double> samples;
+        size_t heapPeak = 0, allocations = 0;
+        std::string output;
+        for (size_t r = 0; r < repeat; ++r) {
+            RPN rpn;
+            std::stringstream captured;
+            std::streambuf *oldCout = std::cout.rdbuf(captured.rdbuf());
+            AllocCounter::Scope scope;
+            BenchUtils::Stopwatch sw;
+            try {
+                rpn.evaluate(expr);
+            } catch (const std::exception &e) {
+                captured << "exception: " << e.what();
+            }
+            samples.push_back(sw.elapsedNs());
+            heapPeak = scope.peakBytes();
+            allocations = scope.allocations();
+            std::cout.rdbuf(oldCout);
+            output = captured.str();
+        }
+        EXPECT_EQ(output, expected.str()) << tokens << " tokens";
+
+        const double ns = BenchUtils::median(samples);
+        BenchUtils::recordSample("rpn_chain", tokens, ns);
+        std::cout << std::left << std::setw(12) << tokens << " | " << std::fixed << std::setprecision(1)
+                  << std::setw(10) << expr.size() / (1024.0 * 1024.0) << " | " << std::setw(10) << ns / 1e6
+                  << " | " << std::setprecision(2) << std::setw(12) << tokens / (ns / 1e3) << " | "
+                  << std::setw(13) << allocCell(heapPeak / (1024.0 * 1024.0), 1) << " | " << std::setw(10)
+                  << allocCell(static_cast<double>(allocations), 0) << " | " << std::setprecision(1)
+                  << peakRssKb() / 1024.0 << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    std::cout << "Note: heap peak is what evaluate allocates above the expression itself;"
+              << " process RSS is the peak of the whole benchmark so far." << std::endl;
+}
+
+TEST(RPNBench, DeepStackProfile) {
+    if (!AllocCounter::enabled())
+        GTEST_SKIP() << "Set BENCH_COUNT_ALLOCS=1 to count heap allocations";
+    std::vector<size_t> defaults;
+    defaults.push_back(1000);
+    defaults.push_back(100000);
+    defaults.push_back(1000000);
+    defaults.push_back(10000000);
+    const std::vector<size_t> sizes = BenchUtils::envSizes("RPN_DEEP_SIZES", defaults);
+
+    std::cout << "RPN::evaluate on \"1 1 ... + +\" (operand stack grows to N)" << std::endl;
+    std::cout << std::left << std::setw(10) << "N (depth)" << " | " << std::setw(10) << "time ms" << " | "
+              << std::setw(13) << "heap peak MiB" << " | " << std::setw(12) << "allocs" << " | " << std::setw(14)
+              << "bytes/operand" << " | " << "allocs/operand" << std::endl;
+
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        const size_t operands = sizes[i] ? sizes[i] : 1;
+        const std::string expr = makeDeepExpression(operands);
+        std::ostringstream expected;
+        expected << operands << "\n";
+
+        RPN rpn;
+        std::stringstream captured;
+        std::streambuf *oldCout = std::cout.rdbuf(captured.rdbuf());
+        AllocCounter::Scope scope;
+        BenchUtils::Stopwatch sw;
+        try {
+            rpn.evaluate(expr);
+        } catch (const std::exception &e) {
+            captured << "exception: " << e.what();
+        }
+        const double ns = sw.elapsedNs();
+        // 式のコピー (istringstreamなど) とスタックは区別できないので、表では式の長さを差し引く
+        const size_t heapPeak = scope.peakBytes();
+        const size_t allocations = scope.allocations();
+        std::cout.rdbuf(oldCout);
+        EXPECT_EQ(captured.str(), expected.str()) << operands << " operands";
+
+        const double n = static_cast<double>(operands);
+        const double stackBytes = heapPeak > expr.size() ? static_cast<double>(heapPeak - expr.size()) : 0.0;
+        std::cout << std::left << std::setw(10) << operands << " | " << std::fixed << std::setprecision(1)
+                  << std::setw(10) << ns / 1e6 << " | " << std::setw(13) << heapPeak / (1024.0 * 1024.0) << " | "
+                  << std::setw(12) << allocations << " | " << std::setprecision(2) << std::setw(14)
+                  << stackBytes / n << " | " << std::setprecision(4) << allocations / n << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    std::cout << "Note: bytes/operand excludes one copy of the expression (e.g. an istringstream);"
+              << " a node-based stack shows 1 alloc/operand." << std::endl;
+}
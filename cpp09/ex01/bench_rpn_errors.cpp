@@ -0,0 +1,139 @@
+#include "AllocCounter.hpp"
+#include "BenchUtils.hpp"
+#include "RPN.hpp"
+#include "gtest/gtest.h"
+#include <iomanip>
+#include <sstream>
+
+// --- Error-path throughput benchmark for RPN::evaluate ---
+// 不正な式を種類ごとに大量に流し、1秒あたりに処理できるエラーの数と
+// 1回の例外あたりのヒープ確保回数を、同じくらいの長さの正しい式と比べる。
+// 例外のたびにstringstreamでメッセージを組み立てる実装は、エラー側だけが
+// 何十倍も遅くなるので、"vs valid" の列にそれが出る。
+//   valid       : 正しい式 (基準)
+//   shortage    : オペランド不足 ("1 +" など)
+//   surplus     : オペランドの余り ("1 2 3 +" など)
+//   div by zero : ゼロ除算
+//   bad token   : 数字と演算子以外・2桁の数
+//   parentheses : 括弧
+// 例外を投げなかった不正な式は "accepted" として数え、失敗にする。
+// std::cerrへの出力 (エラーメッセージ) は捨てる。
+// 例外オブジェクト自体の領域 (__cxa_allocate_exception) はoperator newを通らないので、
+// allocs/callには例外のメッセージ文字列などの確保だけが数えられる。
+//
+// 環境変数:
+//   RPN_ERR_COUNT      種類ごとの呼び出し回数 (default: 1000000)
+//   BENCH_COUNT_ALLOCS 1でヒープ確保を数える (未設定ならallocs/callは "n/a")
+
+namespace {
+
+// BENCH_COUNT_ALLOCS がないときは数えていないので "n/a"
+std::string allocCell(double value) {
+    if (!AllocCounter::enabled())
+        return "n/a";
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << value;
+    return oss.str();
+}
+
+struct Category {
+    const char *name;
+    bool valid;
+    std::vector<std::string> exprs;
+};
+
+std::vector<Category> categories() {
+    std::vector<Category> list;
+    Category valid = {"valid", true, std::vector<std::string>()};
+    valid.exprs.push_back("1 2 +");
+    valid.exprs.push_back("8 9 * 9 - 9 - 9 - 4 - 1 +");
+    valid.exprs.push_back("7 7 * 7 -");
+    valid.exprs.push_back("1 2 * 2 / 2 * 2 4 - +");
+    list.push_back(valid);
+
+    Category shortage = {"shortage", false, std::vector<std::string>()};
+    shortage.exprs.push_back("+");
+    shortage.exprs.push_back("1 +");
+    shortage.exprs.push_back("1 2 + * 3 4 5");
+    shortage.exprs.push_back("8 9 * 9 - 9 - 9 - 4 - + +");
+    list.push_back(shortage);
+
+    Category surplus = {"surplus", false, std::vector<std::string>()};
+    surplus.exprs.push_back("1 2");
+    surplus.exprs.push_back("1 2 3 +");
+    surplus.exprs.push_back("8 9 * 9 - 9 - 9 - 4 - 1");
+    surplus.exprs.push_back("7 7 * 7 - 7 7");
+    list.push_back(surplus);
+
+    Category divZero = {"div by zero", false, std::vector<std::string>()};
+    divZero.exprs.push_back("1 0 /");
+    divZero.exprs.push_back("5 3 3 - /");
+    divZero.exprs.push_back("8 9 * 9 - 9 - 9 - 0 /");
+    divZero.exprs.push_back("1 2 + 0 / 4 *");
+    list.push_back(divZero);
+
+    Category badToken = {"bad token", false, std::vector<std::string>()};
+    badToken.exprs.push_back("1 a +");
+    badToken.exprs.push_back("12 3 +");
+    badToken.exprs.push_back("1 2 % 3");
+    badToken.exprs.push_back("8 9 * 9 - 9 - 9 - 4 - 1.5 +");
+    list.push_back(badToken);
+
+    Category parens = {"parentheses", false, std::vector<std::string>()};
+    parens.exprs.push_back("(1 + 1)");
+    parens.exprs.push_back("( 1 2 + )");
+    parens.exprs.push_back("1 ( 2 3 + ) *");
+    parens.exprs.push_back("8 9 * 9 - 9 - ( 9 - 4 ) - 1 +");
+    list.push_back(parens);
+    return list;
+}
+
+} // namespace
+
+TEST(RPNBench, ErrorPath) {
+    const size_t count = BenchUtils::envSize("RPN_ERR_COUNT", 1000000);
+    const std::vector<Category> list = categories();
+
+    std::cout << "RPN::evaluate on malformed expressions (" << count << " calls per category)" << std::endl;
+    std::cout << std::left << std::setw(12) << "category" << " | " << std::setw(10) << "ns/call" << " | "
+              << std::setw(12) << "calls/s" << " | " << std::setw(11) << "allocs/call" << " | " << std::setw(8)
+              << "vs valid" << " | " << "accepted" << std::endl;
+
+    double validNs = 0;
+    for (size_t c = 0; c < list.size(); ++c) {
+        const Category &category = list[c];
+        RPN rpn;
+        size_t thrown = 0;
+        double ns;
+        size_t allocations;
+        {
+            BenchUtils::SilenceStdStreams silence;
+            AllocCounter::Scope scope;
+            BenchUtils::Stopwatch sw;
+            for (size_t i = 0; i < count; ++i) {
+                try {
+                    rpn.evaluate(category.exprs[i % category.exprs.size()]);
+                } catch (const std::exception &) {
+                    ++thrown;
+                }
+            }
+            ns = sw.elapsedNs() / static_cast<double>(count ? count : 1);
+            allocations = scope.allocations();
+        }
+        const size_t accepted = count - thrown;
+        if (category.valid) {
+            validNs = ns;
+            EXPECT_EQ(thrown, 0u) << "valid expressions threw";
+        } else {
+            EXPECT_EQ(accepted, 0u) << category.name << " expressions were accepted";
+        }
+
+        std::cout << std::left << std::setw(12) << category.name << " | " << std::fixed << std::setprecision(1)
+                  << std::setw(10) << ns << " | " << std::setprecision(0) << std::setw(12) << 1e9 / ns << " | "
+                  << std::setprecision(2) << std::setw(11)
+                  << allocCell(allocations / static_cast<double>(count ? count : 1)) << " | " << std::setw(8) << (validNs > 0 ? ns / validNs : 0.0) << " | "
+                  << (category.valid ? std::string("-") : std::to_string(accepted)) << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    std::cout << "Note: 'vs valid' is the cost of one failing call relative to one successful call." << std::endl;
+}
@@ -0,0 +1,131 @@
+#include "AllocCounter.hpp"
+#include "BenchUtils.hpp"
+#include "RPN.hpp"
+#include "RpnReference.hpp"
+#include "gtest/gtest.h"
+#include <iomanip>
+#include <sstream>
+
+// --- Instance reuse: state-leak detector and per-call cost ---
+// test_rpn.cpp は呼び出しごとに新しいRPNを作るが、組み込んで使うなら1つのインスタンスで
+// evaluateを何度も呼びたい。成功する式と失敗する式 (途中でスタックに値を残したまま
+// 例外になるもの) を混ぜた列を、
+//   fresh  : 呼び出しごとに新しいインスタンス
+//   reused : 1つのインスタンスを使い回す
+// の2通りで実行し、各呼び出しの結果 (出力と例外の有無) が一致するかを調べる。
+// 一致しなければ、前の呼び出しの状態 (スタックの残り) が次の呼び出しに漏れている。
+// あわせて1回あたりの時間とヒープ確保回数を比べ、使い回しでスタックの再確保が
+// 避けられているかを見る。
+//
+// 環境変数:
+//   RPN_REUSE_CALLS    計測する呼び出しの回数 (default: 1000000)
+//   BENCH_COUNT_ALLOCS 1でヒープ確保を数える (未設定ならallocs/callは "n/a")
+
+namespace {
+
+const size_t kMaxReportedLeaks = 10;
+
+// BENCH_COUNT_ALLOCS がないときは数えていないので "n/a"
+std::string allocCell(double value) {
+    if (!AllocCounter::enabled())
+        return "n/a";
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << value;
+    return oss.str();
+}
+
+// 失敗する式はスタックに値を残した状態で例外になるものを選ぶ
+std::vector<std::string> mixedExpressions() {
+    std::vector<std::string> list;
+    list.push_back("1 2 +");
+    list.push_back("9 8 7 6 5 0 /");         // ゼロ除算、スタックに4つ残る
+    list.push_back("+");                     // 前の残りがあると成功してしまう
+    list.push_back("8 9 * 9 - 9 - 9 - 4 - 1 +");
+    list.push_back("1 2 3 4 a");             // 不正なトークン、スタックに4つ残る
+    list.push_back("5 *");                   // 前の残りがあると成功してしまう
+    list.push_back("7 7 * 7 -");
+    list.push_back("1 2 3");                 // オペランドの余り
+    list.push_back("4 -");                   // 前の残りがあると成功してしまう
+    list.push_back("1 2 * 2 / 2 * 2 4 - +");
+    list.push_back("3 4 + + 5 6");           // オペランド不足、スタックに1つ残る
+    list.push_back("2");
+    return list;
+}
+
+struct Cost {
+    double ns;
+    double allocs;
+};
+
+// 式の列を calls 回ぶん順に実行する。reuse が false なら呼び出しごとに新しいインスタンス
+Cost measure(const std::vector<std::string> &exprs, size_t calls, bool reuse) {
+    std::stringstream buffer;
+    RPN shared;
+    AllocCounter::Scope scope;
+    BenchUtils::Stopwatch sw;
+    for (size_t i = 0; i < calls; ++i) {
+        const std::string &expr = exprs[i % exprs.size()];
+        if (reuse) {
+            RpnReference::run(shared, expr, buffer);
+        } else {
+            RPN fresh;
+            RpnReference::run(fresh, expr, buffer);
+        }
+    }
+    Cost cost;
+    cost.ns = sw.elapsedNs() / static_cast<double>(calls ? calls : 1);
+    cost.allocs = scope.allocations() / static_cast<double>(calls ? calls : 1);
+    return cost;
+}
+
+} // namespace
+
+TEST(RPNBench, InstanceReuse) {
+    const size_t calls = BenchUtils::envSize("RPN_REUSE_CALLS", 1000000);
+    const std::vector<std::string> exprs = mixedExpressions();
+
+    // 1. 新しいインスタンスでの結果を正解とし、使い回したインスタンスと比べる
+    std::vector<RpnReference::Actual> expected;
+    std::stringstream buffer;
+    for (size_t i = 0; i < exprs.size(); ++i) {
+        RPN fresh;
+        expected.push_back(RpnReference::run(fresh, exprs[i], buffer));
+    }
+    RPN shared;
+    size_t leaks = 0;
+    std::string report;
+    for (size_t pass = 0; pass < 3; ++pass) {
+        for (size_t i = 0; i < exprs.size(); ++i) {
+            const RpnReference::Actual actual = RpnReference::run(shared, exprs[i], buffer);
+            if (actual.threw == expected[i].threw && actual.output == expected[i].output)
+                continue;
+            if (++leaks > kMaxReportedLeaks)
+                continue;
+            // 最初の呼び出しの前には何も実行していない
+            const std::string before = pass == 0 && i == 0
+                                           ? std::string("first call")
+                                           : "after \"" + exprs[(i + exprs.size() - 1) % exprs.size()] + "\"";
+            report += "  " + before + ": \"" + exprs[i] + "\" gave " + RpnReference::describe(actual) +
+                      ", fresh instance gave " + RpnReference::describe(expected[i]) + "\n";
+        }
+    }
+    EXPECT_EQ(leaks, 0u) << "State leaks between evaluate calls on one instance:\n" << report;
+
+    // 2. 1回あたりのコスト
+    const Cost fresh = measure(exprs, calls, false);
+    const Cost reused = measure(exprs, calls, true);
+    std::cout << "RPN::evaluate on " << exprs.size() << " alternating valid/failing expressions (" << calls
+              << " calls)" << std::endl;
+    std::cout << std::left << std::setw(8) << "mode" << " | " << std::setw(10) << "ns/call" << " | "
+              << std::setw(11) << "allocs/call" << " | " << "vs fresh" << std::endl;
+    std::cout << std::left << std::setw(8) << "fresh" << " | " << std::fixed << std::setprecision(1)
+              << std::setw(10) << fresh.ns << " | " << std::setprecision(2) << std::setw(11) << allocCell(fresh.allocs)
+              << " | " << 1.0 << std::endl;
+    std::cout << std::left << std::setw(8) << "reused" << " | " << std::setprecision(1) << std::setw(10)
+              << reused.ns << " | " << std::setprecision(2) << std::setw(11) << allocCell(reused.allocs) << " | "
+              << (fresh.ns > 0 ? reused.ns / fresh.ns : 0.0) << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << "State leaks on the reused instance: " << leaks << std::endl;
+    std::cout << "Note: allocs/call includes capturing std::cout; fewer allocs when reused means the"
+              << " stack storage survives between calls." << std::endl;
+}
@@ -0,0 +1,145 @@
+#include "BenchUtils.hpp"
+#include "Parallel.hpp"
+#include "RPN.hpp"
+#include "RpnReference.hpp"
+#include "gtest/gtest.h"
+#include <cstdio> // For snprintf
+#include <iomanip>
+
+// --- Differential testing of RPN::evaluate against RpnReference ---
+// ランダムに生成した有効な1桁RPN式を、全コアに分けたプロセス (Parallel::forkShards) で
+// RPN::evaluateとRpnReference::evaluateの両方に通し、結果を比べる。
+// evaluateはstd::coutに書くので、スレッドではなくプロセスで分ける。
+// 式 i はシード mix(RPN_DIFF_SEED, i) から作るので、失敗したシードを
+// RPN_DIFF_REPLAY に渡すとその1式だけを再現できる。
+//
+// 環境変数:
+//   RPN_DIFF_COUNT      式の総数 (default: 2000000)
+//   RPN_DIFF_MAX_TOKENS 1式の最大トークン数 (default: 15)
+//   RPN_DIFF_SEED       基準のシード (default: 1)
+//   RPN_DIFF_REPLAY     このシードの式だけを実行する
+//   PARALLEL_JOBS       プロセス数 (default: コア数)
+
+namespace {
+
+const size_t kMaxReportedFailures = 10;
+
+unsigned long long expressionSeed(unsigned long long base, size_t index) {
+    BenchUtils::Rng mix(base ^ (0x9e3779b97f4a7c15ULL * (index + 1)));
+    return mix.next();
+}
+
+// オペランドk個・演算子k-1個の有効な式。途中のスタックは常に1以上。
+std::string randomExpression(unsigned long long seed, size_t maxTokens) {
+    static const char kOps[] = "+-*/";
+    BenchUtils::Rng rng(seed);
+    const size_t operands = static_cast<size_t>(rng.range(1, static_cast<long>((maxTokens + 1) / 2)));
+    std::string expr;
+    size_t pushed = 0, applied = 0, depth = 0;
+    while (pushed < operands || applied + 1 < operands) {
+        const bool canPush = pushed < operands;
+        const bool canApply = depth >= 2 && applied + 1 < operands;
+        if (!expr.empty())
+            expr += ' ';
+        if (canPush && (!canApply || rng.range(0, 1) == 0)) {
+            expr += static_cast<char>('0' + rng.range(0, 9));
+            ++pushed;
+            ++depth;
+        } else {
+            expr += kOps[rng.range(0, 3)];
+            ++applied;
+            --depth;
+        }
+    }
+    return expr;
+}
+
+std::string failureLine(unsigned long long seed, const std::string &expr, const RpnReference::Result &expected,
+                        const RpnReference::Actual &actual) {
+    char head[64];
+    std::snprintf(head, sizeof(head), "seed=%llu", seed);
+    return std::string(head) + " expr=\"" + expr + "\" expected=" + RpnReference::describe(expected) +
+           " actual=" + RpnReference::describe(actual) + "\n";
+}
+
+// 1シャード分: "checked ambiguous errors mismatches" の1行と、失敗した式の行を返す
+std::string runShard(unsigned shard, unsigned shards, size_t count, size_t maxTokens, unsigned long long base) {
+    RPN rpn;
+    std::stringstream buffer;
+    size_t checked = 0, ambiguous = 0, errors = 0, mismatches = 0;
+    std::string failures;
+    for (size_t i = shard; i < count; i += shards) {
+        const unsigned long long seed = expressionSeed(base, i);
+        const std::string expr = randomExpression(seed, maxTokens);
+        const RpnReference::Result expected = RpnReference::evaluate(expr);
+        if (expected.outcome == RpnReference::AMBIGUOUS) {
+            ++ambiguous;
+            continue;
+        }
+        errors += expected.outcome == RpnReference::ERROR;
+        ++checked;
+        // 状態の持ち越しを避けるため、失敗した後は新しいインスタンスにする
+        const RpnReference::Actual actual = RpnReference::run(rpn, expr, buffer);
+        if (actual.threw)
+            rpn = RPN();
+        if (!RpnReference::matches(expected, actual)) {
+            if (++mismatches <= kMaxReportedFailures)
+                failures += failureLine(seed, expr, expected, actual);
+        }
+    }
+    std::ostringstream head;
+    head << checked << ' ' << ambiguous << ' ' << errors << ' ' << mismatches << '\n';
+    return head.str() + failures;
+}
+
+} // namespace
+
+TEST(RPNStress, DifferentialAgainstReference) {
+    const size_t maxTokens = BenchUtils::envSize("RPN_DIFF_MAX_TOKENS", 15);
+    const unsigned long long base = BenchUtils::envSize("RPN_DIFF_SEED", 1);
+
+    const char *replay = std::getenv("RPN_DIFF_REPLAY");
+    if (replay != NULL && *replay != '\0') {
+        const unsigned long long seed = std::strtoull(replay, NULL, 10);
+        const std::string expr = randomExpression(seed, maxTokens);
+        RPN rpn;
+        std::stringstream buffer;
+        const RpnReference::Result expected = RpnReference::evaluate(expr);
+        const RpnReference::Actual actual = RpnReference::run(rpn, expr, buffer);
+        std::cout << failureLine(seed, expr, expected, actual);
+        EXPECT_TRUE(RpnReference::matches(expected, actual));
+        return;
+    }
+
+    const size_t count = BenchUtils::envSize("RPN_DIFF_COUNT", 2000000);
+    const unsigned shards = Parallel::workerCount();
+    BenchUtils::Stopwatch sw;
+    const std::vector<Parallel::ShardResult> results = Parallel::forkShards(
+        shards, [&](unsigned shard, unsigned n) { return runShard(shard, n, count, maxTokens, base); });
+    const double sec = sw.elapsedSec();
+
+    size_t checked = 0, ambiguous = 0, errors = 0, mismatches = 0;
+    std::string failures;
+    for (unsigned s = 0; s < results.size(); ++s) {
+        EXPECT_TRUE(results[s].ok()) << "shard " << s << " died (wait status " << results[s].status << ")";
+        std::istringstream report(results[s].report);
+        size_t c = 0, a = 0, e = 0, m = 0;
+        report >> c >> a >> e >> m;
+        checked += c;
+        ambiguous += a;
+        errors += e;
+        mismatches += m;
+        std::string line;
+        std::getline(report, line);
+        while (std::getline(report, line))
+            failures += "  " + line + "\n";
+    }
+
+    std::cout << count << " expressions (up to " << maxTokens << " tokens) on " << shards << " processes in "
+              << std::fixed << std::setprecision(2) << sec << "s: " << std::setprecision(0) << count / sec * 60
+              << " expressions/min" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << "  compared: " << checked << " (" << errors << " expected errors), skipped as ambiguous: "
+              << ambiguous << ", mismatches: " << mismatches << std::endl;
+    EXPECT_EQ(mismatches, 0u) << "Replay one with RPN_DIFF_REPLAY=<seed>:\n" << failures;
+}
@@ -0,0 +1,165 @@
+#include "BenchUtils.hpp"
+#include "Parallel.hpp"
+#include "RPN.hpp"
+#include "RpnReference.hpp"
+#include "gtest/gtest.h"
+#include <iomanip>
+
+// --- Exhaustive enumeration of short RPN token sequences ---
+// 0-9 と + - * / の14種類のトークンを空白区切りで並べた列を、長さ1から
+// RPN_ENUM_MAX_LEN まで全部作り、RPN::evaluateとRpnReference::evaluateの
+// 結果 (値か例外か、値そのもの) を比べる。有効な式も無効な式 (オペランド不足・余り・
+// ゼロ除算) もすべて含むので、この長さまでは取りこぼしがない。
+// 長さkの列は14^k通りあり、長さkの列の番号を14進数として読んだものが列そのものになる。
+// 番号の範囲をプロセス数で連続したブロックに分け (Parallel::forkShards)、
+// 各プロセスはブロックの先頭から桁上がりで次の列を作る。
+//
+// 件数の目安: 長さ6までで約810万、7までで約1.1億、9までで約220億。
+//
+// 環境変数:
+//   RPN_ENUM_MAX_LEN 最大トークン数 (default: 6)
+//   PARALLEL_JOBS    プロセス数 (default: コア数)
+
+namespace {
+
+const char kTokens[] = "0123456789+-*/";
+const size_t kAlphabet = sizeof(kTokens) - 1;
+const size_t kMaxReportedFailures = 10;
+
+unsigned long long power(size_t base, size_t exp) {
+    unsigned long long r = 1;
+    for (size_t i = 0; i < exp; ++i)
+        r *= base;
+    return r;
+}
+
+struct Tally {
+    size_t checked;
+    size_t ambiguous;
+    size_t errors;
+    size_t mismatches;
+
+    Tally() : checked(0), ambiguous(0), errors(0), mismatches(0) {}
+};
+
+// 長さlengthの列のうち、番号 [begin, end) を調べる
+void enumerate(size_t length, unsigned long long begin, unsigned long long end, Tally &tally,
+               std::string &failures) {
+    if (begin >= end)
+        return;
+    // digits[0] が最上位の桁
+    std::vector<size_t> digits(length);
+    unsigned long long rest = begin;
+    for (size_t d = length; d-- > 0;) {
+        digits[d] = static_cast<size_t>(rest % kAlphabet);
+        rest /= kAlphabet;
+    }
+    std::string expr(2 * length - 1, ' ');
+    for (size_t d = 0; d < length; ++d)
+        expr[2 * d] = kTokens[digits[d]];
+
+    RPN rpn;
+    std::stringstream buffer;
+    for (unsigned long long index = begin; index < end; ++index) {
+        const RpnReference::Result expected = RpnReference::evaluate(expr);
+        if (expected.outcome == RpnReference::AMBIGUOUS) {
+            ++tally.ambiguous;
+        } else {
+            tally.errors += expected.outcome == RpnReference::ERROR;
+            ++tally.checked;
+            const RpnReference::Actual actual = RpnReference::run(rpn, expr, buffer);
+            if (actual.threw)
+                rpn = RPN();
+            if (!RpnReference::matches(expected, actual) && ++tally.mismatches <= kMaxReportedFailures)
+                failures += "expr=\"" + expr + "\" expected=" + RpnReference::describe(expected) +
+                            " actual=" + RpnReference::describe(actual) + "\n";
+        }
+        // 桁上がり
+        for (size_t d = length; d-- > 0;) {
+            if (++digits[d] < kAlphabet) {
+                expr[2 * d] = kTokens[digits[d]];
+                break;
+            }
+            digits[d] = 0;
+            expr[2 * d] = kTokens[0];
+        }
+    }
+}
+
+// total個の番号をshards個の連続したブロックに分けたときの、shard番目のブロックの先頭
+// (total * shard / shards はtotalが14^16だとオーバーフローするので、商と余りで計算する)
+unsigned long long shardBegin(unsigned long long total, unsigned shard, unsigned shards) {
+    const unsigned long long rest = total % shards;
+    return total / shards * shard + (shard < rest ? shard : rest);
+}
+
+// 1シャード分: 長さごとに "length checked ambiguous errors mismatches" の行と、失敗した式の行を返す
+std::string runShard(unsigned shard, unsigned shards, size_t maxLength) {
+    std::ostringstream report;
+    std::string failures;
+    for (size_t length = 1; length <= maxLength; ++length) {
+        const unsigned long long total = power(kAlphabet, length);
+        const unsigned long long begin = shardBegin(total, shard, shards);
+        const unsigned long long end = shardBegin(total, shard + 1, shards);
+        Tally tally;
+        enumerate(length, begin, end, tally, failures);
+        report << length << ' ' << tally.checked << ' ' << tally.ambiguous << ' ' << tally.errors << ' '
+               << tally.mismatches << '\n';
+    }
+    return report.str() + failures;
+}
+
+} // namespace
+
+TEST(RPNStress, ExhaustiveEnumeration) {
+    const size_t maxLength = BenchUtils::envSize("RPN_ENUM_MAX_LEN", 6);
+    ASSERT_GE(maxLength, 1u);
+    ASSERT_LE(maxLength, 16u) << "14^17 does not fit in 64 bits";
+    const unsigned shards = Parallel::workerCount();
+
+    BenchUtils::Stopwatch sw;
+    const std::vector<Parallel::ShardResult> results = Parallel::forkShards(
+        shards, [&](unsigned shard, unsigned n) { return runShard(shard, n, maxLength); });
+    const double sec = sw.elapsedSec();
+
+    std::vector<Tally> byLength(maxLength + 1);
+    std::string failures;
+    for (unsigned s = 0; s < results.size(); ++s) {
+        EXPECT_TRUE(results[s].ok()) << "shard " << s << " died (wait status " << results[s].status << ")";
+        std::istringstream report(results[s].report);
+        for (size_t l = 1; l <= maxLength; ++l) {
+            size_t length = 0;
+            Tally t;
+            report >> length >> t.checked >> t.ambiguous >> t.errors >> t.mismatches;
+            if (length < 1 || length > maxLength)
+                break;
+            byLength[length].checked += t.checked;
+            byLength[length].ambiguous += t.ambiguous;
+            byLength[length].errors += t.errors;
+            byLength[length].mismatches += t.mismatches;
+        }
+        std::string line;
+        std::getline(report, line);
+        while (std::getline(report, line))
+            failures += "  " + line + "\n";
+    }
+
+    std::cout << std::left << std::setw(6) << "len" << " | " << std::setw(12) << "sequences" << " | "
+              << std::setw(12) << "values" << " | " << std::setw(12) << "errors" << " | " << std::setw(10)
+              << "ambiguous" << " | " << "mismatches" << std::endl;
+    unsigned long long total = 0;
+    size_t mismatches = 0;
+    for (size_t l = 1; l <= maxLength; ++l) {
+        const Tally &t = byLength[l];
+        total += power(kAlphabet, l);
+        mismatches += t.mismatches;
+        EXPECT_EQ(t.checked + t.ambiguous, power(kAlphabet, l)) << "length " << l << " was not fully covered";
+        std::cout << std::left << std::setw(6) << l << " | " << std::setw(12) << power(kAlphabet, l) << " | "
+                  << std::setw(12) << t.checked - t.errors << " | " << std::setw(12) << t.errors << " | "
+                  << std::setw(10) << t.ambiguous << " | " << t.mismatches << std::endl;
+    }
+    std::cout << total << " sequences on " << shards << " processes in " << std::fixed << std::setprecision(2)
+              << sec << "s (" << std::setprecision(0) << total / sec << " sequences/s)" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+    EXPECT_EQ(mismatches, 0u) << "First mismatches:\n" << failures;
+}
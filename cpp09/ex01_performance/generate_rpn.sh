@@ -1,15 +1,37 @@
 #!/bin/bash
 
 # This script generates a long, valid RPN expression for performance testing.
-# The expression will be of the form "1 2 + 2 + 2 + ..."
-# Usage: ./generate_rpn.sh <number_of_tokens>
+# Modes:
+#   chain (default) : "1 2 + 2 + 2 + ..."  The operand stack never exceeds depth two.
+#   deep            : "1 1 1 ... + + +"    All N operands are pushed before the first
+#                                          operator, so the stack grows to N.
+#                                          The argument is the operand count N.
+# Usage: ./generate_rpn.sh <number_of_tokens> [chain]
+#        ./generate_rpn.sh <number_of_operands> deep
 
-if [ "$#" -ne 1 ]; then
-    echo "Usage: $0 <number_of_tokens>" >&2
+if [ "$#" -lt 1 ] || [ "$#" -gt 2 ]; then
+    echo "Usage: $0 <number_of_tokens> [chain] | $0 <number_of_operands> deep" >&2
     exit 1
 fi
 
 NUM_TOKENS=$1
+MODE=${2:-chain}
+
+if [ "$MODE" = "deep" ]; then
+    # N operands and N-1 operators (2N-1 tokens); the result is N.
+    awk -v count="$NUM_TOKENS" '
+    BEGIN {
+        n = int(count);
+        if (n < 1) n = 1;
+        printf "1";
+        for (i = 1; i < n; i++) printf " 1";
+        for (i = 1; i < n; i++) printf " +";
+    }'
+    exit 0
+elif [ "$MODE" != "chain" ]; then
+    echo "Usage: $0 <number_of_tokens> [chain] | $0 <number_of_operands> deep" >&2
+    exit 1
+fi
 
 # Ensure an even number of tokens for simplicity, as we add pairs of "+ 2"
 if (( NUM_TOKENS % 2 != 0 )); then
@@ -14,10 +14,26 @@ NC='\033[0m' # No Color
 PRJ_DIR="../../../cpp09/ex01"
 EXECUTABLE="./$PRJ_DIR/RPN"
 EXPR_GENERATOR="./generate_rpn.sh"
+# Runs a program and reports "<elapsed_seconds> <max_rss_kib> <exit_status>" (built by 'make tools')
+MEASURE="../tools/measure"
+MEASURE_REPORT="measure.log"
+# Fits the in-process (M, time) samples against O(1) ... O(n^2) (built by 'make tools')
+COMPLEXITY_FIT="../tools/complexity_fit"
+SAMPLES_FILE="samples.txt"
+# gtest-linked benchmark calling RPN::evaluate directly (built by 'make ex01_bench')
+BENCH_APP="../ex01_bench_app"
+BENCH_SIZES=(1000000 10000000 100000000)
+# Operand counts for the deep-stack profile ("1 1 ... + +", see '$EXPR_GENERATOR <operands> deep')
+DEEP_SIZES=(1000 100000 1000000 10000000)
+# Calls per category of malformed expression in the error-path benchmark
+ERROR_COUNT=1000000
+# Calls in the instance-reuse benchmark (fresh RPN per call vs one shared RPN)
+REUSE_CALLS=1000000
 
 # Array of token counts to test
-# Start with smaller numbers and increase. 1 million+ may be slow depending on machine.
-TEST_SIZES=(10000 50000 100000 200000)
+# The expression is passed as a single argument, which Linux caps at 128 KiB
+# (MAX_ARG_STRLEN): about 65000 tokens of "2 +". Larger sizes fail with E2BIG.
+TEST_SIZES=(10000 20000 40000 60000)
 
 # --- Pre-flight Checks ---
 if [ ! -f "$EXECUTABLE" ]; then
@@ -30,6 +46,11 @@ if [ ! -x "$EXPR_GENERATOR" ]; then
     echo -e "${YELLOW}Please run 'chmod +x $EXPR_GENERATOR'.${NC}"
     exit 1
 fi
+if [ ! -x "$MEASURE" ] || [ ! -x "$COMPLEXITY_FIT" ]; then
+    echo -e "${RED}Error: '$MEASURE' or '$COMPLEXITY_FIT' not found.${NC}"
+    echo -e "${YELLOW}Please build them first with 'make tools' in the cpp09 directory.${NC}"
+    exit 1
+fi
 
 # --- Test Execution ---
 echo -e "--- Running Performance Tests for RPN ---"
@@ -55,12 +76,46 @@ for M in "${TEST_SIZES[@]}"; do
 	#EXEC_TIME=$( (/usr/bin/time -f "%e" cat x | xargs "$EXECUTABLE" > /dev/null) 2>&1 )
     #EXEC_TIME=$( (/usr/bin/time -f "%e" "$EXECUTABLE" '`echo -n $EXPRESSION`' > /dev/null) 2>&1 )
     #EXEC_TIME=$( (/usr/bin/time -f "%e" "$EXECUTABLE" "$EXPRESSION" > /dev/null) 2>&1 )
-    EXEC_TIME=$( (/usr/bin/time -f "%e" "$EXECUTABLE" "`$EXPR_GENERATOR $M`" > /dev/null) 2>&1 )
-    printf "${CYAN}%-15s${NC}\n" "${EXEC_TIME}s"
+    "$MEASURE" -o "$MEASURE_REPORT" "$EXECUTABLE" "`$EXPR_GENERATOR $M`" > /dev/null 2>&1
+    read -r EXEC_TIME _ EXIT_STATUS < "$MEASURE_REPORT"
+    rm -f "$MEASURE_REPORT"
+    if [ "$EXIT_STATUS" -ne 0 ]; then
+        printf "${RED}%-15s${NC}\n" "failed (exit $EXIT_STATUS)"
+        continue
+    fi
+    printf "${CYAN}%-15s${NC}\n" "$(awk -v t="$EXEC_TIME" 'BEGIN { printf "%.3fs", t }')"
 done
 
 # --- Summary ---
 echo "---------------------------------------------------------"
 echo -e "${GREEN}Test finished.${NC}"
-echo "Observe how the 'RPN Exec Time' grows roughly linearly with 'Expression Tokens (M)'."
-echo "This demonstrates the O(M) efficiency of the RPN algorithm."
+
+# --- In-process Throughput ---
+# Beyond the argv limit, the expression is built in memory and passed to RPN::evaluate.
+# The wall times above are a few ms, mostly fork/exec, so the complexity fit uses
+# these in-process times instead. The RPN algorithm is expected to be O(M); the
+# stage fails only if the samples clearly fit a worse class.
+FIT_STATUS=0
+if [ -x "$BENCH_APP" ]; then
+    echo ""
+    rm -f "$SAMPLES_FILE"
+    BENCH_SAMPLES="$SAMPLES_FILE" RPN_BENCH_SIZES="${BENCH_SIZES[*]}" \
+        "$BENCH_APP" --gtest_filter=RPNBench.Throughput --gtest_brief=1
+    awk '$1 == "rpn_chain" { print $2, $3 }' "$SAMPLES_FILE" | "$COMPLEXITY_FIT" --expect n
+    FIT_STATUS=$?
+    rm -f "$SAMPLES_FILE"
+    # The chain expressions above keep the stack at depth two; this one grows it to N.
+    echo ""
+    # Heap counting is opt-in, so the timing benchmarks above run on the plain allocator.
+    BENCH_COUNT_ALLOCS=1 RPN_DEEP_SIZES="${DEEP_SIZES[*]}" \
+        "$BENCH_APP" --gtest_filter=RPNBench.DeepStackProfile --gtest_brief=1
+    # Graders feed many malformed expressions too; compare the cost of a throw with a valid call.
+    echo ""
+    RPN_ERR_COUNT="$ERROR_COUNT" "$BENCH_APP" --gtest_filter=RPNBench.ErrorPath --gtest_brief=1
+    # Embedding reuses one evaluator; this also fails if state leaks from one call to the next.
+    echo ""
+    RPN_REUSE_CALLS="$REUSE_CALLS" "$BENCH_APP" --gtest_filter=RPNBench.InstanceReuse --gtest_brief=1
+else
+    echo -e "${YELLOW}Skip in-process throughput: '$BENCH_APP' not found (build it with 'make ex01_bench').${NC}"
+fi
+exit $FIT_STATUS
@@ -0,0 +1,129 @@
+#include "AllocCounter.hpp"
+#include "BenchUtils.hpp"
+#include "PmergeData.hpp"
+#include "PmergeMe.hpp"
+#include "gtest/gtest.h"
+#include <deque>
+#include <dlfcn.h>    // For dladdr
+#include <execinfo.h> // For backtrace
+#include <iomanip>
+#include <vector>
+
+// --- Heap allocations of mergeInsertSort by recursion depth ---
+// mergeInsertSortの中のoperator newを (AllocCounter::setHookで) 1回ずつ捕まえ、
+// そのときのコールスタックから再帰の深さを求めて、深さごとに回数とバイト数を集計する。
+// 深さは「スタックに同じ関数が何回現れるか - 1」で、関数の先頭アドレスはdladdrで引く
+// (シンボルを引くために -rdynamic でリンクする)。mergeInsertSortを呼ぶ前にスタックの
+// 長さを覚えておき、それより上のフレームだけを見るので、gtest側の関数は数えない。
+// 多くの実装は各段でペアのvectorやpend chainを新しく確保するので、深さごとに
+// 同じくらいのバイト数が並び、合計はO(n log n)になる。使い回すバッファを1つ持つ実装なら
+// 合計は入力の数倍 ("churn / input" の列) で収まる。
+//
+// 環境変数:
+//   PMERGE_ALLOC_SIZES 要素数のリスト (default: 10000)
+//   BENCH_COUNT_ALLOCS 1でヒープ確保を数える (未設定ならスキップ)
+
+namespace {
+
+const int kMaxFrames = 256;
+const size_t kMaxDepth = 63;
+
+struct DepthProfile {
+    size_t allocations[kMaxDepth + 1];
+    size_t bytes[kMaxDepth + 1];
+    size_t unresolved; // dladdrが関数を引けなかったフレームの数
+};
+
+DepthProfile g_profile;
+int g_baseFrames = 0;
+
+// AllocCounterのフック。スタック上で最も多く現れる関数の回数から深さを求める
+void recordAllocation(size_t size) {
+    void *frames[kMaxFrames];
+    const int total = backtrace(frames, kMaxFrames);
+    const int own = total - g_baseFrames;
+    void *functions[kMaxFrames];
+    int resolved = 0;
+    // frames[0] (この関数) と frames[own - 1] (profileSort) は無名名前空間にあって
+    // dladdrで引けないうえ、1回ずつしか現れないので飛ばす
+    for (int i = 1; i < own - 1; ++i) {
+        Dl_info info;
+        if (dladdr(frames[i], &info) != 0 && info.dli_saddr != NULL)
+            functions[resolved++] = info.dli_saddr;
+        else
+            ++g_profile.unresolved;
+    }
+    size_t most = 1;
+    for (int i = 0; i < resolved; ++i) {
+        size_t count = 0;
+        for (int j = 0; j < resolved; ++j)
+            count += functions[j] == functions[i];
+        if (count > most)
+            most = count;
+    }
+    const size_t depth = most - 1 < kMaxDepth ? most - 1 : kMaxDepth;
+    ++g_profile.allocations[depth];
+    g_profile.bytes[depth] += size;
+}
+
+// mergeInsertSortを呼ぶフレーム。ここでのスタックの長さが集計の基準になる
+template <typename C> __attribute__((noinline)) void profileSort(C &c) {
+    void *frames[kMaxFrames];
+    PmergeMe sorter;
+    g_profile = DepthProfile();
+    g_baseFrames = backtrace(frames, kMaxFrames) - 1; // profileSort自身のフレームは集計に含める
+    AllocCounter::setHook(recordAllocation);
+    sorter.mergeInsertSort(c);
+    AllocCounter::setHook(NULL);
+}
+
+template <typename C> void printProfile(const char *container, size_t n) {
+    const std::vector<int> input = PmergeData::generate(PmergeData::UNIFORM, n, n);
+    C c(input.begin(), input.end());
+    profileSort(c);
+    const DepthProfile profile = g_profile;
+
+    size_t allocations = 0, bytes = 0, deepest = 0;
+    for (size_t d = 0; d <= kMaxDepth; ++d) {
+        allocations += profile.allocations[d];
+        bytes += profile.bytes[d];
+        if (profile.allocations[d] > 0)
+            deepest = d;
+    }
+    const double inputBytes = static_cast<double>(n * sizeof(int));
+    std::cout << container << ", N = " << n << std::endl;
+    std::cout << std::left << std::setw(6) << "depth" << " | " << std::setw(10) << "allocs" << " | "
+              << std::setw(12) << "bytes" << " | " << "bytes / input" << std::endl;
+    for (size_t d = 0; d <= deepest; ++d) {
+        std::cout << std::left << std::setw(6) << d << " | " << std::setw(10) << profile.allocations[d] << " | "
+                  << std::setw(12) << profile.bytes[d] << " | " << std::fixed << std::setprecision(2)
+                  << profile.bytes[d] / inputBytes << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    std::cout << std::left << std::setw(6) << "total" << " | " << std::setw(10) << allocations << " | "
+              << std::setw(12) << bytes << " | " << std::fixed << std::setprecision(2) << bytes / inputBytes
+              << " (churn / input)" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+    if (profile.unresolved > 0)
+        std::cout << "Note: " << profile.unresolved << " stack frames had no symbol; depths may be too low"
+                  << " (link with -rdynamic)." << std::endl;
+    std::cout << std::endl;
+}
+
+} // namespace
+
+TEST(PmergeMeBench, AllocationsByDepth) {
+    if (!AllocCounter::enabled())
+        GTEST_SKIP() << "Set BENCH_COUNT_ALLOCS=1 to count heap allocations";
+    std::vector<size_t> defaults(1, 10000);
+    const std::vector<size_t> sizes = BenchUtils::envSizes("PMERGE_ALLOC_SIZES", defaults);
+    // 最初のbacktraceはlibgccを読み込むので、計測の前に1回呼んでおく
+    void *warmUp[1];
+    backtrace(warmUp, 1);
+
+    std::cout << "Heap allocations inside mergeInsertSort, by recursion depth" << std::endl;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        printProfile<std::vector<int> >("std::vector", sizes[i]);
+        printProfile<std::deque<int> >("std::deque", sizes[i]);
+    }
+}
@@ -0,0 +1,93 @@
+#include "BenchUtils.hpp"
+#include "PerfCounters.hpp"
+#include "PmergeData.hpp"
+#include "PmergeMe.hpp"
+#include "gtest/gtest.h"
+#include <deque>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+// --- Hardware/software counters around mergeInsertSort (vector vs deque) ---
+// 「vectorとdequeのどちらが速いか」を時間だけでなく、perf_event_openで読んだ
+// 命令数・キャッシュ参照/ミス・分岐予測ミスで比べる。dequeはチャンクに分かれた
+// 記憶領域なので、二分探索での挿入のたびにキャッシュミスが増えることが数値で見える。
+// 命令数は実行のたびのばらつきが小さく、時間よりも実装どうしの比較に向く。
+// ハードウェアのイベントが使えない環境 (仮想マシン、perf_event_paranoid) では
+// ソフトウェアのイベント (task-clock、ページフォールト) だけを表示する。
+// 値は1要素あたりに割った数で、"n/a" は読めなかったイベント。
+//
+// 環境変数:
+//   PMERGE_COUNTER_SIZES 要素数のリスト (default: 1000 10000 100000)
+
+namespace {
+
+// 1要素あたりの値 (読めなければ "n/a")
+std::string perElement(const PerfCounters::Reading &r, size_t n, double scale = 1.0) {
+    if (!r.valid)
+        return "n/a";
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << static_cast<double>(r.value) / scale / static_cast<double>(n);
+    return oss.str();
+}
+
+std::string missRate(const PerfCounters::Reading &misses, const PerfCounters::Reading &refs) {
+    if (!misses.valid || !refs.valid || refs.value == 0)
+        return "n/a";
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(1) << 100.0 * static_cast<double>(misses.value) / refs.value << "%";
+    return oss.str();
+}
+
+template <typename C> void measureRow(const char *container, const std::vector<int> &input) {
+    typedef PerfCounters::Group G;
+    C c(input.begin(), input.end());
+    PmergeMe sorter;
+    G counters;
+    BenchUtils::Stopwatch sw;
+    counters.start();
+    sorter.mergeInsertSort(c);
+    counters.stop();
+    const double ns = sw.elapsedNs();
+    const size_t n = input.size();
+    std::cout << std::left << std::setw(9) << n << " | " << std::setw(11) << container << " | " << std::fixed
+              << std::setprecision(2) << std::setw(9) << ns / 1e6 << " | " << std::setw(10)
+              << perElement(counters.value(G::INSTRUCTIONS), n) << " | " << std::setw(10)
+              << perElement(counters.value(G::CACHE_REFERENCES), n) << " | " << std::setw(10)
+              << perElement(counters.value(G::CACHE_MISSES), n) << " | " << std::setw(6)
+              << missRate(counters.value(G::CACHE_MISSES), counters.value(G::CACHE_REFERENCES)) << " | "
+              << std::setw(10) << perElement(counters.value(G::BRANCH_MISSES), n) << " | " << std::setw(10)
+              << perElement(counters.value(G::TASK_CLOCK_NS), n) << " | "
+              << perElement(counters.value(G::PAGE_FAULTS), n, 1.0 / 1000) << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+} // namespace
+
+TEST(PmergeMeBench, Counters) {
+    std::vector<size_t> defaults;
+    defaults.push_back(1000);
+    defaults.push_back(10000);
+    defaults.push_back(100000);
+    const std::vector<size_t> sizes = BenchUtils::envSizes("PMERGE_COUNTER_SIZES", defaults);
+
+    {
+        PerfCounters::Group probe;
+        if (!probe.available())
+            GTEST_SKIP() << "perf_event_open is unavailable here (" << probe.error() << ")";
+        if (!probe.hardware())
+            std::cout << "Hardware events are unavailable (" << probe.error()
+                      << "); showing software events only." << std::endl;
+    }
+    std::cout << "Counters per element around mergeInsertSort (random ints)" << std::endl;
+    std::cout << std::left << std::setw(9) << "N" << " | " << std::setw(11) << "container" << " | " << std::setw(9)
+              << "ms" << " | " << std::setw(10) << "instr" << " | " << std::setw(10) << "cache refs" << " | "
+              << std::setw(10) << "cache miss" << " | " << std::setw(6) << "miss%" << " | " << std::setw(10)
+              << "br. miss" << " | " << std::setw(10) << "task ns" << " | " << "faults/1000" << std::endl;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        const std::vector<int> input = PmergeData::generate(PmergeData::UNIFORM, sizes[i], sizes[i]);
+        measureRow<std::vector<int> >("std::vector", input);
+        measureRow<std::deque<int> >("std::deque", input);
+    }
+    std::cout << "Note: counters cover user space only; 'faults/1000' is page faults per 1000 elements." << std::endl;
+}
@@ -0,0 +1,82 @@
+#include "BenchUtils.hpp"
+#include "PmergeData.hpp"
+#include "PmergeMe.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <deque>
+#include <iomanip>
+#include <vector>
+
+// --- Input-distribution matrix for PmergeMe::mergeInsertSort ---
+// generate_numbers.sh は一様な乱数しか作らないので、形の違う入力
+// (PmergeData::Shape: 昇順・降順・山型・のこぎり型・値が16種類・k回だけ入れ替えた昇順・全部同じ値)
+// でvectorとdequeのソート時間を測り、Nごとに表にする。
+// 二分挿入の探索範囲やdequeのチャンク境界は入力の形で大きく変わるので、一様乱数
+// ("uniform" の行) との比 "vs uniform" で形ごとの得意・不得意を見る。
+// 結果はstd::sortと一致すること。
+//
+// 環境変数:
+//   PMERGE_DIST_SIZES  要素数のリスト (default: 1000 10000 30000)
+//   PMERGE_DIST_SWAPS  nearly-sortedでの入れ替え回数 (default: 10)
+//   PMERGE_DIST_REPEAT 繰り返し回数、中央値を採用 (default: 3)
+
+namespace {
+
+template <typename C> double timeSort(const std::vector<int> &input, const std::vector<int> &expected, size_t n,
+                                      const char *shape, const char *container) {
+    C c(input.begin(), input.end());
+    PmergeMe sorter;
+    BenchUtils::Stopwatch sw;
+    sorter.mergeInsertSort(c);
+    const double ns = sw.elapsedNs();
+    EXPECT_TRUE(c.size() == expected.size() && std::equal(c.begin(), c.end(), expected.begin()))
+        << container << " result differs from std::sort for " << shape << " at N=" << n;
+    return ns;
+}
+
+} // namespace
+
+TEST(PmergeMeBench, DistributionMatrix) {
+    std::vector<size_t> defaults;
+    defaults.push_back(1000);
+    defaults.push_back(10000);
+    defaults.push_back(30000);
+    const std::vector<size_t> sizes = BenchUtils::envSizes("PMERGE_DIST_SIZES", defaults);
+    const size_t swaps = BenchUtils::envSize("PMERGE_DIST_SWAPS", 10);
+    const size_t repeat = BenchUtils::envSize("PMERGE_DIST_REPEAT", 3);
+
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        const size_t n = sizes[i];
+        std::cout << "N = " << n << " (nearly-sorted: " << swaps << " swaps)" << std::endl;
+        std::cout << std::left << std::setw(14) << "shape" << " | " << std::setw(10) << "vector ms" << " | "
+                  << std::setw(10) << "deque ms" << " | " << std::setw(12) << "vector/deque" << " | "
+                  << "vs uniform (vector, deque)" << std::endl;
+        double uniformVec = 0, uniformDeq = 0;
+        for (size_t s = 0; s < PmergeData::kShapeCount; ++s) {
+            const PmergeData::Shape shape = PmergeData::kAllShapes[s];
+            const char *name = PmergeData::shapeName(shape);
+            const std::vector<int> input = PmergeData::generate(shape, n, n, swaps);
+            std::vector<int> expected(input);
+            std::sort(expected.begin(), expected.end());
+
+            std::vector<double> vecNs, deqNs;
+            for (size_t r = 0; r < repeat; ++r) {
+                vecNs.push_back(timeSort<std::vector<int> >(input, expected, n, name, "std::vector"));
+                deqNs.push_back(timeSort<std::deque<int> >(input, expected, n, name, "std::deque"));
+            }
+            const double vec = BenchUtils::median(vecNs);
+            const double deq = BenchUtils::median(deqNs);
+            if (shape == PmergeData::UNIFORM) {
+                uniformVec = vec;
+                uniformDeq = deq;
+            }
+            std::cout << std::left << std::setw(14) << name << " | " << std::fixed << std::setprecision(2)
+                      << std::setw(10) << vec / 1e6 << " | " << std::setw(10) << deq / 1e6 << " | " << std::setw(12)
+                      << (deq > 0 ? vec / deq : 0.0) << " | " << (uniformVec > 0 ? vec / uniformVec : 0.0) << ", "
+                      << (uniformDeq > 0 ? deq / uniformDeq : 0.0) << std::endl;
+            std::cout.unsetf(std::ios::floatfield);
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "Note: 'vs uniform' < 1 means the shape sorts faster than random input." << std::endl;
+}
@@ -0,0 +1,258 @@
+#include "BenchUtils.hpp"
+#include "PmergeData.hpp"
+#include "PmergeMe.hpp"
+#include "Subprocess.hpp"
+#include "gtest/gtest.h"
+#include <climits> // For PATH_MAX
+#include <cstdio>  // For remove
+#include <cstdlib> // For realpath, strtoul
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+// --- Stdout cost of printing the Before/After sequences ---
+// PmergeMeは入力と出力の数列を全部表示するので、Nが大きいと出力の整形と書き込みに
+// ソートそのものより時間がかかることがある。実行ファイルをstdoutが /dev/null の場合と
+// パイプ (このプロセスが読み取る) の場合で起動し、Nごとに
+//   wall      : fork から終了までの時間 (PMERGE_OUTPUT_REPEAT 回の中央値、シムなし)
+//   bytes     : stdoutに書かれたバイト数
+//   writes    : stdoutへのwrite/writevシステムコールの回数
+//   write(2)  : それらのシステムコールの中にいた時間 (パイプが詰まって待った時間を含む)
+// を表にする。bytes・writes・write(2) は tools/write_audit.so (LD_PRELOAD) で1回だけ数える。
+// 整形の時間はプロセスの外からは見えないので、main.cppと同じ書き方 (" " << 値) で同じ数列を
+// このプロセスの中で捨てるだけのストリームに整形して測る ("format")。"sort" はこのプロセスの中で
+// vectorとdequeをソートした時間の合計で、"output %" = (format + write(2)) / wall。
+// 数列は引数で渡すので、ARG_MAXに入らないNは飛ばす。
+//
+// 環境変数:
+//   PMERGE_EXECUTABLE     PmergeMeの実行ファイル (未設定ならスキップ)
+//   PMERGE_WRITE_AUDIT    write_audit.so のパス (未設定ならbytes以外は "n/a")
+//   PMERGE_OUTPUT_SIZES   要素数のリスト (default: 1000 10000 50000)
+//   PMERGE_OUTPUT_REPEAT  繰り返し回数、中央値を採用 (default: 3)
+
+namespace {
+
+enum Sink { DEV_NULL, PIPE };
+
+struct Audit {
+    bool valid;
+    std::string mode; // seccomp ならstdio内部の書き込みも見える
+    unsigned long writes;
+    unsigned long bytes;
+    double writeNs;
+
+    Audit() : valid(false), writes(0), bytes(0), writeNs(0) {}
+};
+
+// 書かれた文字を数えて捨てる、バッファ付きのstreambuf (std::coutと同じくまとめて書き出す)
+class DiscardBuf : public std::streambuf {
+  public:
+    DiscardBuf() : _bytes(0) { setp(_buf, _buf + sizeof(_buf)); }
+
+    size_t bytes() const { return _bytes + static_cast<size_t>(pptr() - pbase()); }
+
+  protected:
+    int_type overflow(int_type c) override {
+        _bytes += static_cast<size_t>(pptr() - pbase());
+        setp(_buf, _buf + sizeof(_buf));
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+            sputc(traits_type::to_char_type(c));
+        return traits_type::not_eof(c);
+    }
+
+  private:
+    char _buf[4096];
+    size_t _bytes;
+};
+
+// 引数のリストが ARG_MAX に入るか (文字列と終端、ポインタ、環境変数の分を含めて)
+bool fitsArgMax(const std::vector<std::string> &command) {
+    size_t total = 4096; // 環境変数の分の余裕
+    for (size_t i = 0; i < command.size(); ++i)
+        total += command[i].size() + 1 + sizeof(char *);
+    const long argMax = sysconf(_SC_ARG_MAX);
+    return argMax <= 0 || total < static_cast<size_t>(argMax);
+}
+
+// "write_audit: fd=1 write=... writev=... bytes=... ns=..." の行を読む
+Audit readAudit(const std::string &path) {
+    Audit audit;
+    std::ifstream in(path.c_str());
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string field;
+        bool stdoutLine = false;
+        Audit row;
+        while (fields >> field) {
+            const std::string::size_type eq = field.find('=');
+            if (eq == std::string::npos)
+                continue;
+            const std::string key = field.substr(0, eq);
+            const std::string value = field.substr(eq + 1);
+            if (key == "mode")
+                audit.mode = value;
+            else if (key == "fd")
+                stdoutLine = value == "1";
+            else if (key == "write" || key == "writev")
+                row.writes += std::strtoul(value.c_str(), NULL, 10);
+            else if (key == "bytes")
+                row.bytes = std::strtoul(value.c_str(), NULL, 10);
+            else if (key == "ns")
+                row.writeNs = static_cast<double>(std::strtoul(value.c_str(), NULL, 10));
+        }
+        if (stdoutLine) {
+            audit.valid = true;
+            audit.writes = row.writes;
+            audit.bytes = row.bytes;
+            audit.writeNs = row.writeNs;
+        }
+    }
+    return audit;
+}
+
+Subprocess::Result runOnce(Sink sink, const std::vector<std::string> &command, const std::vector<std::string> &env,
+                           size_t &captured) {
+    if (sink == DEV_NULL)
+        return Subprocess::runToFile(command, "/dev/null", env);
+    std::string out, err;
+    const Subprocess::Result result = Subprocess::runCaptured(command, out, err, env);
+    captured = out.size();
+    return result;
+}
+
+// main.cppと同じ書き方で "Before:" と "After:" の行を整形する時間 (ns)
+double formatNs(const std::vector<int> &input, const std::vector<int> &sorted, size_t &bytes) {
+    DiscardBuf buf;
+    std::ostream out(&buf);
+    BenchUtils::Stopwatch sw;
+    out << "Before:";
+    for (size_t i = 0; i < input.size(); ++i)
+        out << " " << input[i];
+    out << std::endl;
+    out << "After:";
+    for (size_t i = 0; i < sorted.size(); ++i)
+        out << " " << sorted[i];
+    out << std::endl;
+    const double ns = sw.elapsedNs();
+    bytes = buf.bytes();
+    return ns;
+}
+
+std::string formatCell(bool valid, double value, int precision) {
+    if (!valid)
+        return "n/a";
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(precision) << value;
+    return oss.str();
+}
+
+} // namespace
+
+TEST(PmergeMeBench, OutputCost) {
+    const char *executable = std::getenv("PMERGE_EXECUTABLE");
+    if (executable == NULL || *executable == '\0')
+        GTEST_SKIP() << "Set PMERGE_EXECUTABLE to the PmergeMe program";
+    std::vector<size_t> defaults;
+    defaults.push_back(1000);
+    defaults.push_back(10000);
+    defaults.push_back(50000);
+    const std::vector<size_t> sizes = BenchUtils::envSizes("PMERGE_OUTPUT_SIZES", defaults);
+    const size_t repeat = BenchUtils::envSize("PMERGE_OUTPUT_REPEAT", 3);
+
+    // LD_PRELOADは子プロセスの作業ディレクトリから解決されるので、絶対パスにしておく
+    std::string shim;
+    const char *shimPath = std::getenv("PMERGE_WRITE_AUDIT");
+    char resolved[PATH_MAX];
+    if (shimPath != NULL && *shimPath != '\0' && realpath(shimPath, resolved) != NULL)
+        shim = resolved;
+    std::ostringstream logName;
+    logName << "/tmp/pmerge_write_audit." << getpid() << ".log";
+    const std::string auditLog = logName.str();
+    std::vector<std::string> auditEnv;
+    auditEnv.push_back("LD_PRELOAD=" + shim);
+    auditEnv.push_back("WRITE_AUDIT_LOG=" + auditLog);
+
+    std::cout << "Stdout cost of '" << executable << "' (wall: median of " << repeat << ", ms)" << std::endl;
+    if (shim.empty())
+        std::cout << "PMERGE_WRITE_AUDIT is not set or not found; write counts are not available." << std::endl;
+    std::cout << std::left << std::setw(8) << "N" << " | " << std::setw(9) << "sink" << " | " << std::setw(9)
+              << "wall" << " | " << std::setw(10) << "bytes" << " | " << std::setw(7) << "writes" << " | "
+              << std::setw(8) << "write(2)" << " | " << std::setw(8) << "format" << " | " << std::setw(8) << "sort"
+              << " | " << "output %" << std::endl;
+
+    std::string mode;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        const size_t n = sizes[i];
+        const std::vector<int> input = PmergeData::generate(PmergeData::UNIFORM, n, n);
+        std::vector<std::string> command(1, executable);
+        for (size_t k = 0; k < input.size(); ++k) {
+            std::ostringstream oss;
+            oss << input[k];
+            command.push_back(oss.str());
+        }
+        if (!fitsArgMax(command)) {
+            std::cout << std::left << std::setw(8) << n << " | skipped: the arguments do not fit in ARG_MAX"
+                      << std::endl;
+            continue;
+        }
+
+        // このプロセスの中での整形とソートの時間
+        std::vector<int> v(input);
+        std::deque<int> d(input.begin(), input.end());
+        PmergeMe sorter;
+        BenchUtils::Stopwatch sortSw;
+        sorter.mergeInsertSort(v);
+        sorter.mergeInsertSort(d);
+        const double sortNs = sortSw.elapsedNs();
+        size_t formattedBytes = 0;
+        const double fmtNs = formatNs(input, v, formattedBytes);
+
+        const Sink sinks[] = {DEV_NULL, PIPE};
+        size_t programBytes = 0;
+        for (size_t s = 0; s < 2; ++s) {
+            std::vector<double> wallNs;
+            size_t captured = 0;
+            for (size_t r = 0; r < repeat; ++r) {
+                const Subprocess::Result result = runOnce(sinks[s], command, std::vector<std::string>(), captured);
+                ASSERT_TRUE(result.exitedWith(0)) << executable << " failed on " << n << " numbers";
+                wallNs.push_back(result.elapsedSec * 1e9);
+            }
+            Audit audit;
+            if (!shim.empty()) {
+                std::remove(auditLog.c_str());
+                size_t ignored = 0;
+                const Subprocess::Result result = runOnce(sinks[s], command, auditEnv, ignored);
+                ASSERT_TRUE(result.exitedWith(0)) << executable << " failed under write_audit on " << n << " numbers";
+                audit = readAudit(auditLog);
+                std::remove(auditLog.c_str());
+                mode = audit.mode;
+            }
+            const double wall = BenchUtils::median(wallNs);
+            const double bytes = audit.valid ? static_cast<double>(audit.bytes) : static_cast<double>(captured);
+            programBytes = static_cast<size_t>(bytes);
+            const double outputNs = fmtNs + (audit.valid ? audit.writeNs : 0.0);
+            std::cout << std::left << std::setw(8) << n << " | " << std::setw(9)
+                      << (sinks[s] == DEV_NULL ? "/dev/null" : "pipe") << " | " << std::setw(9)
+                      << formatCell(true, wall / 1e6, 2) << " | " << std::setw(10)
+                      << formatCell(audit.valid || sinks[s] == PIPE, bytes, 0) << " | " << std::setw(7)
+                      << formatCell(audit.valid, static_cast<double>(audit.writes), 0) << " | " << std::setw(8)
+                      << formatCell(audit.valid, audit.writeNs / 1e6, 2) << " | " << std::setw(8)
+                      << formatCell(true, fmtNs / 1e6, 2) << " | " << std::setw(8)
+                      << formatCell(true, sortNs / 1e6, 2) << " | "
+                      << formatCell(wall > 0, 100.0 * outputNs / wall, 1) << std::endl;
+        }
+        // 整形の書き方がプログラムと大きく違うなら "format" は当てにならない
+        if (programBytes > 0 && (formattedBytes * 10 < programBytes * 9 || formattedBytes * 10 > programBytes * 11))
+            std::cout << "Note: N=" << n << ": the program wrote " << programBytes << " bytes, the Before/After lines"
+                      << " formatted here are " << formattedBytes << "; 'format' may not match its output."
+                      << std::endl;
+    }
+    if (mode == "interpose")
+        std::cout << "Note: write_audit could only interpose write(); stdio-internal writes are not counted."
+                  << std::endl;
+    std::cout << "Note: 'format' and 'sort' are measured in this process; 'output %' is (format + write(2)) / wall."
+              << std::endl;
+}
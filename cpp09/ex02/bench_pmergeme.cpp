@@ -0,0 +1,137 @@
+#include "BenchUtils.hpp"
+#include "PmergeMe.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <climits> // For INT_MAX
+#include <cmath>   // For log, pow
+#include <deque>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+// --- In-process benchmark for PmergeMe::mergeInsertSort ---
+// 数列をメモリ上で作ってmergeInsertSortを直接呼ぶので、ARG_MAXやxargsによる
+// 分割に関係なく、1e3〜1e7要素を1回のソートとして測れる。
+// 同じデータをstd::vector・std::deque・std::sort (vector) でソートし、
+// 中央値の時間、vector/dequeの比、std::sortとの比を出す。結果はstd::sortと一致すること。
+// 次のNの1回のソートにかかる時間を、遅かった方のコンテナの時間から見積もり、
+// PMERGE_BENCH_BUDGET秒を超えそうならそのNとそれより大きいNは飛ばす
+// (O(n^2)の挿入をしている実装では1e7が終わらないため)。見積もりは直前の2つのNの間で測った
+// 指数 k を使って n^k に比例させる。kが1.5未満なら n log n とし、まだ1つのNしか測っていなければ n^2 とする。
+//
+// 環境変数:
+//   PMERGE_BENCH_SIZES  要素数のリスト (default: 1000 10000 100000 1000000 10000000)
+//   PMERGE_BENCH_REPEAT 1e6要素未満での繰り返し回数、中央値を採用 (default: 3)
+//   PMERGE_BENCH_BUDGET 1回のソートの見積もり時間の上限 (秒, default: 10)
+//   BENCH_SAMPLES       "merge_insert_vector|merge_insert_deque <N> <ns>" を追記するファイル (complexity_fit用)
+
+namespace {
+
+// 直前に測った2つのNと時間から、次のNの時間を見積もる。howに見積もり方を入れる
+double predictNs(size_t prevN, double prevNs, size_t lastN, double lastNs, size_t n, std::string &how) {
+    const double ratio = static_cast<double>(n) / static_cast<double>(lastN);
+    std::ostringstream oss;
+    if (prevN == 0 || prevNs <= 0 || lastNs <= 0) {
+        oss << "n^2 from " << std::fixed << std::setprecision(1) << lastNs / 1e9 << "s at N=" << lastN;
+        how = oss.str();
+        return lastNs * ratio * ratio;
+    }
+    const double k = std::log(lastNs / prevNs) / std::log(static_cast<double>(lastN) / static_cast<double>(prevN));
+    if (k < 1.5) {
+        oss << "n log n from " << std::fixed << std::setprecision(1) << lastNs / 1e9 << "s at N=" << lastN;
+        how = oss.str();
+        return lastNs * ratio * std::log(static_cast<double>(n)) / std::log(static_cast<double>(lastN));
+    }
+    oss << "n^" << std::fixed << std::setprecision(2) << k << " measured from N=" << prevN << " to N=" << lastN
+        << ", " << std::setprecision(1) << lastNs / 1e9 << "s at N=" << lastN;
+    how = oss.str();
+    return lastNs * std::pow(ratio, k);
+}
+
+std::vector<int> randomInput(size_t n, unsigned long long seed) {
+    BenchUtils::Rng rng(seed);
+    std::vector<int> v(n);
+    for (size_t i = 0; i < n; ++i)
+        v[i] = static_cast<int>(rng.range(0, INT_MAX));
+    return v;
+}
+
+// コンテナにコピーしてからソートし、ソートだけの時間を返す
+template <typename C> double timeMergeInsert(const std::vector<int> &input, std::vector<int> &output) {
+    C c(input.begin(), input.end());
+    PmergeMe sorter;
+    BenchUtils::Stopwatch sw;
+    sorter.mergeInsertSort(c);
+    const double ns = sw.elapsedNs();
+    output.assign(c.begin(), c.end());
+    return ns;
+}
+
+double timeStdSort(const std::vector<int> &input, std::vector<int> &output) {
+    output = input;
+    BenchUtils::Stopwatch sw;
+    std::sort(output.begin(), output.end());
+    return sw.elapsedNs();
+}
+
+} // namespace
+
+TEST(PmergeMeBench, LargeInputs) {
+    std::vector<size_t> defaults;
+    for (size_t n = 1000; n <= 10000000; n *= 10)
+        defaults.push_back(n);
+    const std::vector<size_t> sizes = BenchUtils::envSizes("PMERGE_BENCH_SIZES", defaults);
+    const size_t repeatSmall = BenchUtils::envSize("PMERGE_BENCH_REPEAT", 3);
+    const double budgetNs = static_cast<double>(BenchUtils::envSize("PMERGE_BENCH_BUDGET", 10)) * 1e9;
+
+    std::cout << "mergeInsertSort on random ints (built in memory, median of runs)" << std::endl;
+    std::cout << std::left << std::setw(10) << "N" << " | " << std::setw(11) << "vector ms" << " | "
+              << std::setw(11) << "deque ms" << " | " << std::setw(12) << "vector/deque" << " | " << std::setw(12)
+              << "std::sort ms" << " | " << "vector/std::sort" << std::endl;
+
+    // 直前に測った2つのNと、そのときの遅かった方のコンテナの時間
+    size_t prevN = 0, lastN = 0;
+    double prevNs = 0, lastNs = 0;
+    bool overBudget = false;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        const size_t n = sizes[i];
+        std::string how;
+        const double predictedNs = lastN > 0 ? predictNs(prevN, prevNs, lastN, lastNs, n, how) : 0.0;
+        overBudget = overBudget || predictedNs > budgetNs;
+        if (overBudget) {
+            std::cout << std::left << std::setw(10) << n << " | skipped: about " << std::fixed << std::setprecision(1)
+                      << predictedNs / 1e9 << "s per sort (" << how << "), over PMERGE_BENCH_BUDGET="
+                      << budgetNs / 1e9 << "s" << std::endl;
+            std::cout.unsetf(std::ios::floatfield);
+            continue;
+        }
+        const size_t repeat = n >= 1000000 ? 1 : repeatSmall;
+        const std::vector<int> input = randomInput(n, n);
+        std::vector<double> vecNs, deqNs, stdNs;
+        std::vector<int> expected, vecOut, deqOut;
+        for (size_t r = 0; r < repeat; ++r) {
+            stdNs.push_back(timeStdSort(input, expected));
+            vecNs.push_back(timeMergeInsert<std::vector<int> >(input, vecOut));
+            deqNs.push_back(timeMergeInsert<std::deque<int> >(input, deqOut));
+        }
+        EXPECT_TRUE(vecOut == expected) << "std::vector result differs from std::sort at N=" << n;
+        EXPECT_TRUE(deqOut == expected) << "std::deque result differs from std::sort at N=" << n;
+
+        const double vec = BenchUtils::median(vecNs);
+        const double deq = BenchUtils::median(deqNs);
+        const double sorted = BenchUtils::median(stdNs);
+        BenchUtils::recordSample("merge_insert_vector", n, vec);
+        BenchUtils::recordSample("merge_insert_deque", n, deq);
+        std::cout << std::left << std::setw(10) << n << " | " << std::fixed << std::setprecision(2)
+                  << std::setw(11) << vec / 1e6 << " | " << std::setw(11) << deq / 1e6 << " | " << std::setw(12)
+                  << (deq > 0 ? vec / deq : 0.0) << " | " << std::setw(12) << sorted / 1e6 << " | "
+                  << std::setprecision(1) << (sorted > 0 ? vec / sorted : 0.0) << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+        prevN = lastN;
+        prevNs = lastNs;
+        lastN = n;
+        lastNs = std::max(vec, deq);
+    }
+    std::cout << "Note: 'vector/deque' < 1 means std::vector is faster;"
+              << " 'vector/std::sort' is the price of minimising comparisons." << std::endl;
+}
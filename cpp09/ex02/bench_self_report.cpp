@@ -0,0 +1,212 @@
+#include "BenchUtils.hpp"
+#include "PmergeMe.hpp"
+#include "Subprocess.hpp"
+#include "gtest/gtest.h"
+#include <cctype> // For isdigit, isspace
+#include <cerrno>
+#include <climits> // For INT_MAX
+#include <cstdlib> // For strtol, strtod
+#include <deque>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+// --- Parse time vs sort time, and the program's self-reported time ---
+// PmergeMeは "Time to process a range of N elements with std::vector : T us" を自分で出すが、
+// Tに引数の解析 (文字列→int) を含める実装と含めない実装があり、そのままでは比べられない。
+// ここでは同じ数列について
+//   1. 引数の解析とvector/dequeのソートを、このプロセスの中で別々に測る (API経由)
+//   2. 実行ファイルをfork/execで起動し、clock_gettimeで全体の時間を測って、
+//      出力の "std::vector" / "std::deque" の行から自己申告の時間を読む
+// を行い、自己申告の時間が「ソートだけ」「解析+ソート」のどちらに近いかを判定する。
+// "extra/parse" は (自己申告 - ソート) / 解析 で、0付近ならソートだけ、1付近なら解析を含む。
+// 判定はこれが0.5より小さいか大きいか (= どちらの時間に近いか) で決め、vectorとdequeの両方を出す。
+// どちらとも PMERGE_SELF_TOLERANCE 倍以上ずれている、または全体の時間を超えている場合は
+// 自己申告がおかしいとして失敗にする。実行ファイルとこのプログラムのコンパイルオプションが
+// 違うと時間もずれるので、許容範囲は倍率で広めに取る (判定そのものには使わない)。
+//
+// 環境変数:
+//   PMERGE_EXECUTABLE     PmergeMeの実行ファイル (未設定ならスキップ)
+//   PMERGE_SELF_SIZES     要素数のリスト (default: 1000 3000)
+//   PMERGE_SELF_REPEAT    繰り返し回数、中央値を採用 (default: 5)
+//   PMERGE_SELF_TOLERANCE 許容する倍率、小数も可 (default: 3)
+
+namespace {
+
+std::vector<std::string> makeArgs(size_t n) {
+    // 1..nを並べ替えた、重複のない正の整数
+    std::vector<int> values(n);
+    for (size_t i = 0; i < n; ++i)
+        values[i] = static_cast<int>(i + 1);
+    BenchUtils::Rng rng(n);
+    for (size_t i = n; i > 1; --i)
+        std::swap(values[i - 1], values[static_cast<size_t>(rng.range(0, static_cast<long>(i - 1)))]);
+    std::vector<std::string> args;
+    for (size_t i = 0; i < n; ++i) {
+        std::ostringstream oss;
+        oss << values[i];
+        args.push_back(oss.str());
+    }
+    return args;
+}
+
+// 一般的な実装と同じく、strtolで検査しながらvectorに入れる
+bool parseArgs(const std::vector<std::string> &args, std::vector<int> &out) {
+    out.clear();
+    out.reserve(args.size());
+    for (size_t i = 0; i < args.size(); ++i) {
+        char *end;
+        errno = 0;
+        const long x = std::strtol(args[i].c_str(), &end, 10);
+        if (args[i].empty() || *end != '\0' || errno != 0 || x <= 0 || x > INT_MAX)
+            return false;
+        out.push_back(static_cast<int>(x));
+    }
+    return true;
+}
+
+// "... std::vector : 123.4 us" のような行の最後の数値を単位つきで読み、nsで返す (見つからなければ-1)
+double reportedNs(const std::string &output, const char *container) {
+    std::istringstream lines(output);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.find(container) == std::string::npos)
+            continue;
+        double value = -1;
+        std::string unit;
+        for (size_t i = 0; i < line.size();) {
+            if (!std::isdigit(static_cast<unsigned char>(line[i]))) {
+                ++i;
+                continue;
+            }
+            char *end;
+            value = std::strtod(line.c_str() + i, &end);
+            i = static_cast<size_t>(end - line.c_str());
+            size_t u = i;
+            while (u < line.size() && line[u] == ' ')
+                ++u;
+            size_t e = u;
+            while (e < line.size() && !std::isspace(static_cast<unsigned char>(line[e])) && line[e] != ',')
+                ++e;
+            unit = line.substr(u, e - u);
+        }
+        if (value < 0)
+            return -1;
+        if (unit.compare(0, 2, "ns") == 0)
+            return value;
+        if (unit.compare(0, 2, "ms") == 0 || unit.compare(0, 5, "milli") == 0)
+            return value * 1e6;
+        if (unit == "s" || unit.compare(0, 3, "sec") == 0)
+            return value * 1e9;
+        return value * 1e3; // us, µs, microseconds (課題の例)、単位なし
+    }
+    return -1;
+}
+
+bool within(double value, double expected, double factor) {
+    return expected > 0 && value >= expected / factor && value <= expected * factor;
+}
+
+// 自己申告の時間のうちソートを超える分が、解析の時間の何倍か
+double extraOverParse(double said, double sort, double parse) { return parse > 0 ? (said - sort) / parse : 0.0; }
+
+// ソートだけと解析+ソートのどちらに近いか
+std::string verdictFor(double said, double sort, double parse, double wall) {
+    std::string verdict = extraOverParse(said, sort, parse) < 0.5 ? "sort only" : "parse + sort";
+    if (said > wall)
+        verdict += ", longer than the run";
+    return verdict;
+}
+
+} // namespace
+
+TEST(PmergeMeBench, SelfReportedTime) {
+    const char *executable = std::getenv("PMERGE_EXECUTABLE");
+    if (executable == NULL || *executable == '\0')
+        GTEST_SKIP() << "Set PMERGE_EXECUTABLE to the PmergeMe program";
+    std::vector<size_t> defaults;
+    defaults.push_back(1000);
+    defaults.push_back(3000);
+    const std::vector<size_t> sizes = BenchUtils::envSizes("PMERGE_SELF_SIZES", defaults);
+    const size_t repeat = BenchUtils::envSize("PMERGE_SELF_REPEAT", 5);
+    const double factor = BenchUtils::envDouble("PMERGE_SELF_TOLERANCE", 3.0);
+
+    std::cout << "Self-reported time of '" << executable << "' vs in-process parse and sort (median, us)"
+              << std::endl;
+    std::cout << std::left << std::setw(6) << "N" << " | " << std::setw(9) << "parse" << " | " << std::setw(9)
+              << "vec sort" << " | " << std::setw(9) << "deq sort" << " | " << std::setw(9) << "vec said" << " | "
+              << std::setw(9) << "deq said" << " | " << std::setw(9) << "wall" << " | " << std::setw(11)
+              << "extra/parse" << " | " << std::setw(16) << "verdict (vector)" << " | " << "verdict (deque)"
+              << std::endl;
+
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        const size_t n = sizes[i];
+        const std::vector<std::string> args = makeArgs(n);
+
+        // 1. このプロセスの中で、解析とソートを別々に測る
+        std::vector<double> parseNs, vecNs, deqNs;
+        for (size_t r = 0; r < repeat; ++r) {
+            std::vector<int> parsed;
+            BenchUtils::Stopwatch sw;
+            ASSERT_TRUE(parseArgs(args, parsed));
+            parseNs.push_back(sw.elapsedNs());
+
+            std::vector<int> v(parsed);
+            std::deque<int> d(parsed.begin(), parsed.end());
+            PmergeMe sorter;
+            BenchUtils::Stopwatch vecSw;
+            sorter.mergeInsertSort(v);
+            vecNs.push_back(vecSw.elapsedNs());
+            BenchUtils::Stopwatch deqSw;
+            sorter.mergeInsertSort(d);
+            deqNs.push_back(deqSw.elapsedNs());
+        }
+
+        // 2. 実行ファイルを起動して、全体の時間と自己申告の時間を集める
+        std::vector<std::string> command(1, executable);
+        command.insert(command.end(), args.begin(), args.end());
+        std::vector<double> saidVec, saidDeq, wallNs;
+        for (size_t r = 0; r < repeat; ++r) {
+            std::string out, err;
+            const Subprocess::Result result = Subprocess::runCaptured(command, out, err);
+            ASSERT_TRUE(result.exitedWith(0)) << executable << " failed on " << n << " numbers: " << err;
+            saidVec.push_back(reportedNs(out, "std::vector"));
+            saidDeq.push_back(reportedNs(out, "std::deque"));
+            wallNs.push_back(result.elapsedSec * 1e9);
+        }
+
+        const double parse = BenchUtils::median(parseNs);
+        const double vecSort = BenchUtils::median(vecNs);
+        const double deqSort = BenchUtils::median(deqNs);
+        const double vecSaid = BenchUtils::median(saidVec);
+        const double deqSaid = BenchUtils::median(saidDeq);
+        const double wall = BenchUtils::median(wallNs);
+        ASSERT_GE(vecSaid, 0) << "No time found on the std::vector line";
+        ASSERT_GE(deqSaid, 0) << "No time found on the std::deque line";
+
+        const bool vecPlausible = within(vecSaid, vecSort, factor) || within(vecSaid, parse + vecSort, factor);
+        const bool deqPlausible = within(deqSaid, deqSort, factor) || within(deqSaid, parse + deqSort, factor);
+        std::ostringstream extra;
+        extra << std::fixed << std::setprecision(2) << extraOverParse(vecSaid, vecSort, parse) << "/"
+              << extraOverParse(deqSaid, deqSort, parse);
+
+        std::cout << std::left << std::setw(6) << n << " | " << std::fixed << std::setprecision(1) << std::setw(9)
+                  << parse / 1e3 << " | " << std::setw(9) << vecSort / 1e3 << " | " << std::setw(9)
+                  << deqSort / 1e3 << " | " << std::setw(9) << vecSaid / 1e3 << " | " << std::setw(9)
+                  << deqSaid / 1e3 << " | " << std::setw(9) << wall / 1e3 << " | " << std::setw(11) << extra.str()
+                  << " | " << std::setw(16) << verdictFor(vecSaid, vecSort, parse, wall) << " | "
+                  << verdictFor(deqSaid, deqSort, parse, wall) << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+
+        EXPECT_TRUE(vecPlausible) << "N=" << n << ": the std::vector time is more than " << factor
+                                           << "x away from both the sort time and parse + sort time";
+        EXPECT_TRUE(deqPlausible) << "N=" << n << ": the std::deque time is more than " << factor
+            << "x away from both the sort time and parse + sort time";
+        EXPECT_LE(vecSaid, wall) << "N=" << n << ": std::vector time exceeds the wall time of the whole run";
+        EXPECT_LE(deqSaid, wall) << "N=" << n << ": std::deque time exceeds the wall time of the whole run";
+    }
+    std::cout << "Note: 'said' is what the program prints; 'wall' is fork to exit, measured with clock_gettime."
+              << std::endl;
+    std::cout << "Note: 'extra/parse' (vector/deque) = (said - sort) / parse: about 0 is sort only, about 1 includes"
+              << " parsing." << std::endl;
+}
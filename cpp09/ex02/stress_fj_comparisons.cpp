@@ -0,0 +1,221 @@
+#include "BenchUtils.hpp"
+#include "Parallel.hpp"
+#include "PmergeMe.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <iomanip>
+
+// --- Ford-Johnson comparison-count verifier for PmergeMe::mergeInsertSort ---
+// 出力がソートされているかだけなら std::sort でも通るので、比較の回数を数えて
+// Ford-Johnson法の最悪比較回数 F(n) = Σ_{k=1..n} ceil(log2(3k/4)) を超えないことを確かめる。
+// mergeInsertSortはテンプレートなので、比較演算子が呼ばれるたびに数える要素型
+// (Counted) のコンテナを渡す。カウンタはスレッドごと (thread_local) なので、
+// Parallel::runThreads で全コアに分けて実行できる。
+//   WorstCaseAllPermutations : n <= PMERGE_FJ_PERM_MAX の全順列 (10! = 約363万通り)
+//   WorstCaseRandomInputs    : n <= PMERGE_FJ_MAX_N のランダムな順列
+// どちらも結果が 0..n-1 の昇順であることもあわせて確かめる。
+//
+// 環境変数:
+//   PMERGE_FJ_PERM_MAX 全順列を調べる最大のn (default: 10)
+//   PMERGE_FJ_MAX_N    ランダム入力の最大のn (default: 3000)
+//   PMERGE_FJ_TRIALS   ランダム入力でのnごとの試行回数 (default: 20)
+//   PARALLEL_JOBS      スレッド数 (default: コア数)
+
+namespace {
+
+thread_local size_t t_comparisons = 0;
+
+// 比較演算子を呼ぶたびに t_comparisons を1増やす要素型。
+// 実装がどの演算子を使っても数えられるように6つとも用意する。
+struct Counted {
+    int value;
+
+    Counted() : value(0) {}
+    Counted(int v) : value(v) {}
+
+    friend bool operator<(const Counted &a, const Counted &b) {
+        ++t_comparisons;
+        return a.value < b.value;
+    }
+    friend bool operator>(const Counted &a, const Counted &b) {
+        ++t_comparisons;
+        return a.value > b.value;
+    }
+    friend bool operator<=(const Counted &a, const Counted &b) {
+        ++t_comparisons;
+        return a.value <= b.value;
+    }
+    friend bool operator>=(const Counted &a, const Counted &b) {
+        ++t_comparisons;
+        return a.value >= b.value;
+    }
+    friend bool operator==(const Counted &a, const Counted &b) {
+        ++t_comparisons;
+        return a.value == b.value;
+    }
+    friend bool operator!=(const Counted &a, const Counted &b) {
+        ++t_comparisons;
+        return a.value != b.value;
+    }
+};
+
+// F(n): ceil(log2(3k/4)) は 2^(e+2) >= 3k となる最小のe
+size_t fordJohnsonBound(size_t n) {
+    size_t total = 0;
+    for (size_t k = 1; k <= n; ++k) {
+        size_t e = 0;
+        while ((static_cast<size_t>(4) << e) < 3 * k)
+            ++e;
+        total += e;
+    }
+    return total;
+}
+
+struct Stats {
+    size_t cases;
+    size_t worst;
+    double sum;
+    size_t unsorted;
+    std::vector<int> worstInput;
+
+    Stats() : cases(0), worst(0), sum(0), unsorted(0) {}
+
+    void merge(const Stats &o) {
+        if (o.worst > worst || worstInput.empty()) {
+            worst = o.worst;
+            worstInput = o.worstInput;
+        }
+        cases += o.cases;
+        sum += o.sum;
+        unsorted += o.unsorted;
+    }
+};
+
+// 1回ソートして比較回数を記録する
+void sortOnce(const std::vector<int> &input, Stats &stats) {
+    std::vector<Counted> data(input.begin(), input.end());
+    PmergeMe sorter;
+    t_comparisons = 0;
+    sorter.mergeInsertSort(data);
+    const size_t comparisons = t_comparisons;
+    bool sorted = data.size() == input.size();
+    for (size_t i = 0; sorted && i < data.size(); ++i)
+        sorted = data[i].value == static_cast<int>(i);
+    stats.unsorted += !sorted;
+    ++stats.cases;
+    stats.sum += static_cast<double>(comparisons);
+    if (comparisons > stats.worst || stats.worstInput.empty()) {
+        stats.worst = comparisons;
+        stats.worstInput = input;
+    }
+}
+
+std::string join(const std::vector<int> &v) {
+    std::ostringstream oss;
+    for (size_t i = 0; i < v.size(); ++i)
+        oss << (i ? " " : "") << v[i];
+    return oss.str();
+}
+
+void printHeader() {
+    std::cout << std::left << std::setw(6) << "n" << " | " << std::setw(8) << "F(n)" << " | " << std::setw(8)
+              << "worst" << " | " << std::setw(10) << "mean" << " | " << "cases" << std::endl;
+}
+
+// 最悪比較回数がF(n)以下でソートされていることを確かめ、print か失敗なら1行出力する
+void checkRow(size_t n, const Stats &stats, bool print = true) {
+    const size_t bound = fordJohnsonBound(n);
+    if (!print && stats.worst <= bound && stats.unsorted == 0)
+        return;
+    std::cout << std::left << std::setw(6) << n << " | " << std::setw(8) << bound << " | " << std::setw(8)
+              << stats.worst << " | " << std::fixed << std::setprecision(2) << std::setw(10)
+              << stats.sum / static_cast<double>(stats.cases ? stats.cases : 1) << " | " << stats.cases
+              << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+    EXPECT_EQ(stats.unsorted, 0u) << "n=" << n << ": output was not 0..n-1 in order";
+    EXPECT_LE(stats.worst, bound) << "n=" << n << ": " << stats.worst << " comparisons on input \""
+                                  << join(stats.worstInput) << "\" (Ford-Johnson needs at most " << bound << ")";
+}
+
+// ランダム入力で調べるn: 64までは全部、それより上は約1.25倍ずつ、最後にmaxN
+std::vector<size_t> randomSizes(size_t from, size_t maxN) {
+    std::vector<size_t> sizes;
+    for (size_t n = from; n <= maxN; n = n < 64 ? n + 1 : n + n / 4)
+        sizes.push_back(n);
+    if (sizes.empty() || sizes.back() != maxN)
+        sizes.push_back(maxN);
+    return sizes;
+}
+
+} // namespace
+
+TEST(PmergeMeStress, WorstCaseAllPermutations) {
+    const size_t permMax = BenchUtils::envSize("PMERGE_FJ_PERM_MAX", 10);
+    const unsigned workers = Parallel::workerCount();
+    std::cout << "Comparisons of mergeInsertSort over every permutation of 0..n-1" << std::endl;
+    printHeader();
+    for (size_t n = 1; n <= permMax; ++n) {
+        // 先頭の要素でn個のブロックに分け、ブロックをスレッドに配る
+        std::vector<Stats> perWorker(workers);
+        Parallel::runThreads(workers, [&](unsigned worker, unsigned count) {
+            for (size_t first = worker; first < n; first += count) {
+                std::vector<int> rest;
+                for (size_t v = 0; v < n; ++v) {
+                    if (v != first)
+                        rest.push_back(static_cast<int>(v));
+                }
+                std::vector<int> input(1, static_cast<int>(first));
+                do {
+                    input.resize(1);
+                    input.insert(input.end(), rest.begin(), rest.end());
+                    sortOnce(input, perWorker[worker]);
+                } while (std::next_permutation(rest.begin(), rest.end()));
+            }
+        });
+        Stats total;
+        for (unsigned w = 0; w < workers; ++w) {
+            if (perWorker[w].cases > 0)
+                total.merge(perWorker[w]);
+        }
+        checkRow(n, total);
+    }
+}
+
+TEST(PmergeMeStress, WorstCaseRandomInputs) {
+    const size_t permMax = BenchUtils::envSize("PMERGE_FJ_PERM_MAX", 10);
+    const size_t maxN = BenchUtils::envSize("PMERGE_FJ_MAX_N", 3000);
+    const size_t trials = BenchUtils::envSize("PMERGE_FJ_TRIALS", 20);
+    const unsigned workers = Parallel::workerCount();
+    const std::vector<size_t> sizes = randomSizes(permMax + 1, maxN);
+
+    // (n, 試行) の組をまとめてスレッドに配る
+    std::vector<std::vector<Stats> > perWorker(workers, std::vector<Stats>(sizes.size()));
+    BenchUtils::Stopwatch sw;
+    Parallel::runThreads(workers, [&](unsigned worker, unsigned count) {
+        for (size_t job = worker; job < sizes.size() * trials; job += count) {
+            const size_t s = job / trials;
+            std::vector<int> input(sizes[s]);
+            for (size_t i = 0; i < input.size(); ++i)
+                input[i] = static_cast<int>(i);
+            BenchUtils::Rng rng(job + 1);
+            for (size_t i = input.size(); i > 1; --i)
+                std::swap(input[i - 1], input[static_cast<size_t>(rng.range(0, static_cast<long>(i - 1)))]);
+            sortOnce(input, perWorker[worker][s]);
+        }
+    });
+    const double sec = sw.elapsedSec();
+
+    std::cout << "Comparisons of mergeInsertSort on random permutations (" << trials << " per n, " << workers
+              << " threads, " << std::fixed << std::setprecision(2) << sec << "s)" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+    printHeader();
+    for (size_t s = 0; s < sizes.size(); ++s) {
+        Stats total;
+        for (unsigned w = 0; w < workers; ++w) {
+            if (perWorker[w][s].cases > 0)
+                total.merge(perWorker[w][s]);
+        }
+        // 小さいnは行が多いので、64以下は8の倍数と失敗した行だけ表示する
+        checkRow(sizes[s], total, sizes[s] > 64 || sizes[s] % 8 == 0);
+    }
+}
@@ -0,0 +1,217 @@
+#include "BenchUtils.hpp"
+#include "Parallel.hpp"
+#include "PmergeData.hpp"
+#include "PmergeMe.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+// --- Sharded randomized property tests for PmergeMe::mergeInsertSort ---
+// test_pmergeme.cpp のvector/dequeのテストは0〜10要素しか見ないが、ペアを作るときの奇数・偶数の
+// 余りやヤコブスタール数のグループの境目は特定のnでだけ壊れる。そこで
+//   PropertyDenseSizes : 0..PMERGE_PROP_DENSE_MAX のすべてのn
+//   PropertyLargeSizes : それより大きい 2^k-1, 2^k, 2^k+1 (PMERGE_PROP_MAX_N まで) と、
+//                        同じ範囲から対数一様に選んだ PMERGE_PROP_RANDOM 個のn
+// についてランダムな中身をvectorとdequeの両方でソートし、std::sortの結果と一致することを確かめる。
+// 中身の形は半分が一様乱数、1/4が値16種類 (重複が多い)、残りがPmergeDataのほかの形。
+// ケースは Parallel::forEachJob のスレッドプールで重いもの (nが大きいもの) から配る。
+// 大きいnは小さい順にスレッド数ずつ実行し、次のnにかかる時間を今の最も遅いケースから
+// n^2 に比例するとして見積もって、PMERGE_PROP_BUDGET 秒を超えそうならそれより大きいnは飛ばす
+// (O(n^2) の実装で何十分も止まらないように。O(n log n) なら見積もりは大きめに出るだけ)。
+// 失敗したケースはn・形・シードを表示するので、PmergeData::generate(形, n, シード) で再現できる。
+//
+// 環境変数:
+//   PMERGE_PROP_DENSE_MAX すべてのnを調べる上限 (default: 5000)
+//   PMERGE_PROP_MAX_N     大きいnの上限 (default: 1000000)
+//   PMERGE_PROP_RANDOM    大きいnのうち、ランダムに選ぶnの個数 (default: 16)
+//   PMERGE_PROP_SEED      乱数のシード (default: 1)
+//   PMERGE_PROP_BUDGET    大きいnで1ケースにかけてよい秒数 (default: 5)
+//   PARALLEL_JOBS         スレッド数 (default: コア数)
+
+namespace {
+
+const size_t kMaxReported = 20;
+
+struct Case {
+    size_t n;
+    PmergeData::Shape shape;
+    unsigned long long seed;
+};
+
+struct Outcome {
+    std::string failure; // 空なら成功
+    double sec;
+
+    Outcome() : sec(0) {}
+};
+
+// nとPMERGE_PROP_SEEDから中身の形とシードを決める
+Case makeCase(size_t n, unsigned long long seed) {
+    BenchUtils::Rng rng(seed * 0x100000001b3ULL + n);
+    Case c;
+    c.n = n;
+    const long pick = rng.range(0, 7);
+    if (pick < 4)
+        c.shape = PmergeData::UNIFORM;
+    else if (pick < 6)
+        c.shape = PmergeData::FEW_UNIQUE;
+    else
+        c.shape = PmergeData::kAllShapes[static_cast<size_t>(rng.range(0, PmergeData::kShapeCount - 1))];
+    c.seed = rng.next();
+    return c;
+}
+
+template <typename C> std::string compare(const std::vector<int> &input, const std::vector<int> &expected,
+                                          const char *container) {
+    C c(input.begin(), input.end());
+    PmergeMe sorter;
+    sorter.mergeInsertSort(c);
+    std::ostringstream oss;
+    if (c.size() != expected.size()) {
+        oss << container << " has " << c.size() << " elements, expected " << expected.size();
+        return oss.str();
+    }
+    typename C::const_iterator it = c.begin();
+    for (size_t i = 0; i < expected.size(); ++i, ++it) {
+        if (*it != expected[i]) {
+            oss << container << " differs from std::sort at index " << i << ": " << *it << ", expected "
+                << expected[i];
+            return oss.str();
+        }
+    }
+    return "";
+}
+
+Outcome runCase(const Case &c) {
+    BenchUtils::Stopwatch sw;
+    const std::vector<int> input = PmergeData::generate(c.shape, c.n, c.seed);
+    std::vector<int> expected(input);
+    std::sort(expected.begin(), expected.end());
+    Outcome outcome;
+    const std::string vec = compare<std::vector<int> >(input, expected, "std::vector");
+    const std::string deq = compare<std::deque<int> >(input, expected, "std::deque");
+    if (!vec.empty() || !deq.empty())
+        outcome.failure = vec + (!vec.empty() && !deq.empty() ? "; " : "") + deq;
+    outcome.sec = sw.elapsedSec();
+    return outcome;
+}
+
+// ケースをスレッドプールで実行する。casesは重いものが先に来るように並べておく
+std::vector<Outcome> runCases(const std::vector<Case> &cases, unsigned workers) {
+    std::vector<Outcome> outcomes(cases.size());
+    Parallel::forEachJob(cases.size(), workers,
+                         [&](size_t job, unsigned) { outcomes[job] = runCase(cases[job]); });
+    return outcomes;
+}
+
+// 失敗したケースを最大kMaxReported件まで報告し、失敗の数を返す
+size_t reportFailures(const std::vector<Case> &cases, const std::vector<Outcome> &outcomes) {
+    size_t failures = 0;
+    for (size_t i = 0; i < cases.size(); ++i) {
+        if (outcomes[i].failure.empty())
+            continue;
+        if (++failures <= kMaxReported)
+            ADD_FAILURE() << "n=" << cases[i].n << ", shape " << PmergeData::shapeName(cases[i].shape) << ", seed "
+                          << cases[i].seed << ": " << outcomes[i].failure;
+    }
+    if (failures > kMaxReported)
+        std::cout << "... and " << failures - kMaxReported << " more failing cases" << std::endl;
+    return failures;
+}
+
+// DENSE_MAXより大きいn: 2^k-1, 2^k, 2^k+1 と対数一様に選んだn (昇順、重複なし)
+std::vector<size_t> largeSizes(size_t denseMax, size_t maxN, size_t randomCount, unsigned long long seed) {
+    std::vector<size_t> sizes;
+    for (size_t p = 2; p - 1 <= maxN; p *= 2) {
+        for (size_t n = p - 1; n <= p + 1 && n <= maxN; ++n) {
+            if (n > denseMax)
+                sizes.push_back(n);
+        }
+    }
+    if (maxN > denseMax) {
+        BenchUtils::Rng rng(seed);
+        const double lo = std::log(static_cast<double>(denseMax + 1));
+        const double hi = std::log(static_cast<double>(maxN));
+        for (size_t i = 0; i < randomCount; ++i) {
+            const size_t n = static_cast<size_t>(std::exp(lo + (hi - lo) * rng.unit()));
+            sizes.push_back(std::min(std::max(n, denseMax + 1), maxN));
+        }
+    }
+    std::sort(sizes.begin(), sizes.end());
+    sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+    return sizes;
+}
+
+} // namespace
+
+TEST(PmergeMeStress, PropertyDenseSizes) {
+    const size_t denseMax = BenchUtils::envSize("PMERGE_PROP_DENSE_MAX", 5000);
+    const unsigned long long seed = BenchUtils::envSize("PMERGE_PROP_SEED", 1);
+    const unsigned workers = Parallel::workerCount();
+
+    std::vector<Case> cases;
+    for (size_t n = denseMax + 1; n-- > 0;)
+        cases.push_back(makeCase(n, seed));
+    BenchUtils::Stopwatch sw;
+    const std::vector<Outcome> outcomes = runCases(cases, workers);
+    const double sec = sw.elapsedSec();
+
+    const size_t failures = reportFailures(cases, outcomes);
+    std::cout << "Every n in 0.." << denseMax << " (vector and deque vs std::sort): " << cases.size() - failures
+              << "/" << cases.size() << " passed in " << std::fixed << std::setprecision(2) << sec << "s on "
+              << workers << " threads" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+TEST(PmergeMeStress, PropertyLargeSizes) {
+    const size_t denseMax = BenchUtils::envSize("PMERGE_PROP_DENSE_MAX", 5000);
+    const size_t maxN = BenchUtils::envSize("PMERGE_PROP_MAX_N", 1000000);
+    const size_t randomCount = BenchUtils::envSize("PMERGE_PROP_RANDOM", 16);
+    const unsigned long long seed = BenchUtils::envSize("PMERGE_PROP_SEED", 1);
+    const double budget = static_cast<double>(BenchUtils::envSize("PMERGE_PROP_BUDGET", 5));
+    const unsigned workers = Parallel::workerCount();
+    const std::vector<size_t> sizes = largeSizes(denseMax, maxN, randomCount, seed);
+
+    std::cout << "Powers of two +-1 and random n in " << denseMax + 1 << ".." << maxN
+              << " (vector and deque vs std::sort, " << workers << " threads)" << std::endl;
+    std::cout << std::left << std::setw(9) << "n" << " | " << std::setw(13) << "shape" << " | " << std::setw(8)
+              << "sec" << " | " << "result" << std::endl;
+    std::vector<Case> cases;
+    std::vector<Outcome> outcomes;
+    // スレッド数ずつ小さい順に実行し、次のnが予算を超えそうならそこで打ち切る
+    for (size_t first = 0; first < sizes.size(); first += workers) {
+        const size_t last = std::min(first + workers, sizes.size());
+        std::vector<Case> batch;
+        for (size_t i = last; i-- > first;)
+            batch.push_back(makeCase(sizes[i], seed));
+        const std::vector<Outcome> done = runCases(batch, workers);
+        double slowest = 0;
+        for (size_t i = batch.size(); i-- > 0;) {
+            std::cout << std::left << std::setw(9) << batch[i].n << " | " << std::setw(13)
+                      << PmergeData::shapeName(batch[i].shape) << " | " << std::fixed << std::setprecision(3)
+                      << std::setw(8) << done[i].sec << " | " << (done[i].failure.empty() ? "ok" : "FAILED")
+                      << std::endl;
+            std::cout.unsetf(std::ios::floatfield);
+            slowest = std::max(slowest, done[i].sec);
+        }
+        cases.insert(cases.end(), batch.begin(), batch.end());
+        outcomes.insert(outcomes.end(), done.begin(), done.end());
+        if (last == sizes.size())
+            break;
+        const double ratio = static_cast<double>(sizes[last]) / static_cast<double>(sizes[last - 1]);
+        const double predicted = slowest * ratio * ratio;
+        if (predicted > budget) {
+            std::cout << "Skipping " << sizes.size() - last << " larger sizes (n >= " << sizes[last]
+                      << "): the next case would take about " << std::fixed << std::setprecision(1) << predicted
+                      << "s (n^2 from " << slowest << "s), over PMERGE_PROP_BUDGET=" << budget << "s" << std::endl;
+            std::cout.unsetf(std::ios::floatfield);
+            break;
+        }
+    }
+    const size_t failures = reportFailures(cases, outcomes);
+    std::cout << cases.size() - failures << "/" << cases.size() << " large cases passed" << std::endl;
+}
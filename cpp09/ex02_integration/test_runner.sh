@@ -11,6 +11,11 @@ PRJ_DIR="../../../cpp09/ex02"
 EXECUTABLE="./$PRJ_DIR/PmergeMe"
 TMP_OUTPUT="tmp_output.log"
 TMP_ERROR="tmp_error.log"
+TMP_INPUT="tmp_input.log"
+# Verifies CHECK_SORT outputs: sortedness and the same multiset as the input (built by 'make tools')
+SORT_CHECKER="../tools/pmerge_check"
+# Element counts of the large data tests, skipped above what fits in ARG_MAX
+LARGE_SIZES=(${PMERGE_LARGE_SIZES:-3000 100000})
 TEST_COUNT=0
 PASS_COUNT=0
 
@@ -20,18 +25,25 @@ if [ ! -f "$EXECUTABLE" ]; then
     echo -e "${YELLOW}Please compile the program first with 'make'.${NC}"
     exit 1
 fi
+if [ ! -x "$SORT_CHECKER" ]; then
+    echo -e "${RED}Error: '$SORT_CHECKER' not found.${NC}"
+    echo -e "${YELLOW}Please build it first with 'make tools' in the cpp09 directory.${NC}"
+    exit 1
+fi
 
 # --- Test Function ---
 # $1: Test case description
 # $2: Command to execute
 # $3: Expected stdout content (use "CHECK_SORT" for dynamic check)
 # $4: Expected stderr content
+# $5: (optional) File with the input numbers, for CHECK_SORT when "Before:" may be shortened
 run_test() {
     ((TEST_COUNT++))
     DESCRIPTION=$1
     COMMAND=$2
     EXPECTED_STDOUT_CONTENT=$3
     EXPECTED_STDERR_CONTENT=$4
+    INPUT_FILE=$5
 
     # Execute the command and capture output/error
     eval "$COMMAND" > "$TMP_OUTPUT" 2> "$TMP_ERROR"
@@ -40,26 +52,16 @@ run_test() {
 
     # Check stdout
     if [ "$EXPECTED_STDOUT_CONTENT" == "CHECK_SORT" ]; then
-        # Dynamic check for correctness
-        BEFORE_LINE=$(grep "Before:" "$TMP_OUTPUT")
-        AFTER_LINE=$(grep "After:" "$TMP_OUTPUT")
-        TIME_VEC_LINE=$(grep "Time to process.*std::vector" "$TMP_OUTPUT")
-        TIME_DEQ_LINE=$(grep "Time to process.*std::deque" "$TMP_OUTPUT")
-
-        # Check if all required lines exist
-        if [ -z "$BEFORE_LINE" ] || [ -z "$AFTER_LINE" ] || [ -z "$TIME_VEC_LINE" ] || [ -z "$TIME_DEQ_LINE" ]; then
+        # Dynamic check for correctness: both time lines must exist, and the
+        # checker parses "Before:"/"After:" itself (sorted, same numbers as the input)
+        CHECK_RESULT=""
+        if ! grep -q "Time to process.*std::vector" "$TMP_OUTPUT" || ! grep -q "Time to process.*std::deque" "$TMP_OUTPUT"; then
             PASS=false
+            CHECK_RESULT="Missing 'Time to process' line"
+        elif [ -n "$INPUT_FILE" ]; then
+            CHECK_RESULT=$("$SORT_CHECKER" -i "$INPUT_FILE" "$TMP_OUTPUT" 2>&1) || PASS=false
         else
-            # Extract numbers and check if 'After' is sorted
-            AFTER_NUMS=$(echo "$AFTER_LINE" | sed 's/After: *//')
-            SORTED_NUMS=$(echo "$AFTER_NUMS" | tr ' ' '\n' | sort -n | tr '\n' ' ')
-            # Trim trailing space
-            AFTER_NUMS_TRIMMED=$(echo "$AFTER_NUMS" | sed 's/ *$//')
-            SORTED_NUMS_TRIMMED=$(echo "$SORTED_NUMS" | sed 's/ *$//')
-
-            if [ "$AFTER_NUMS_TRIMMED" != "$SORTED_NUMS_TRIMMED" ]; then
-                PASS=false
-            fi
+            CHECK_RESULT=$("$SORT_CHECKER" "$TMP_OUTPUT" 2>&1) || PASS=false
         fi
     else
         # Static check against expected content
@@ -99,14 +101,14 @@ run_test() {
         echo -e "[ ${RED}KO${NC} ] $DESCRIPTION"
         if [ "$EXPECTED_STDOUT_CONTENT" == "CHECK_SORT" ]; then
             echo "--- Validation Failed for Sorted Output ---"
-            echo "Sorted numbers should be: $SORTED_NUMS_TRIMMED"
-            echo "Actual 'After:' line was: $AFTER_NUMS_TRIMMED"
+            echo "$CHECK_RESULT"
         else
             echo "--- Expected STDOUT ---"
             echo "$EXPECTED_STDOUT_CONTENT"
         fi
-        echo "--- Actual STDOUT ---"
-        cat "$TMP_OUTPUT"
+        echo "--- Actual STDOUT (first 2000 bytes) ---"
+        head -c 2000 "$TMP_OUTPUT"
+        echo
         echo "--------------------"
         echo "--- Expected STDERR ---"
         echo "$EXPECTED_STDERR_CONTENT"
@@ -163,22 +165,32 @@ run_test "Edge Case: With duplicates" \
          "CHECK_SORT" \
          ""
 
-# 5. Large Data Test (3000 elements)
-echo -e "${YELLOW}Running large data test (3000 elements)...${NC}"
-# Use jot on macOS or shuf on Linux
-if command -v jot &> /dev/null; then
-    LARGE_INPUT=$(jot -r 3000 1 100000 | tr '\n' ' ')
-else
-    LARGE_INPUT=$(shuf -i 1-100000 -n 3000 | tr '\n' ' ')
-fi
-run_test "Large Data: 3000 random elements" \
-         "$EXECUTABLE $LARGE_INPUT" \
-         "CHECK_SORT" \
-         ""
+# 5. Large Data Tests (PMERGE_LARGE_SIZES, default 3000 and 100000 elements)
+# Each number takes up to 7 bytes plus a pointer in the argument list
+MAX_LARGE=$(( $(getconf ARG_MAX) / 16 ))
+for SIZE in "${LARGE_SIZES[@]}"; do
+    if [ "$SIZE" -gt "$MAX_LARGE" ]; then
+        echo -e "${YELLOW}Skipping large data test ($SIZE elements): more than ARG_MAX allows ($MAX_LARGE)${NC}"
+        continue
+    fi
+    echo -e "${YELLOW}Running large data test ($SIZE elements)...${NC}"
+    # Use jot on macOS or shuf on Linux
+    if command -v jot &> /dev/null; then
+        jot -r "$SIZE" 1 1000000 > "$TMP_INPUT"
+    else
+        shuf -i 1-1000000 -n "$SIZE" > "$TMP_INPUT"
+    fi
+    LARGE_INPUT=$(tr '\n' ' ' < "$TMP_INPUT")
+    run_test "Large Data: $SIZE random elements" \
+             "$EXECUTABLE $LARGE_INPUT" \
+             "CHECK_SORT" \
+             "" \
+             "$TMP_INPUT"
+done
 
 
 # --- Cleanup ---
-rm -f "$TMP_OUTPUT" "$TMP_ERROR"
+rm -f "$TMP_OUTPUT" "$TMP_ERROR" "$TMP_INPUT"
 
 # --- Summary ---
 echo "---------------------------------------------------"
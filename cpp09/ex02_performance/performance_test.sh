@@ -14,6 +14,27 @@ NC='\033[0m' # No Color
 PRJ_DIR="../../../cpp09/ex02"
 EXECUTABLE="./$PRJ_DIR/PmergeMe"
 NUM_GENERATOR="./generate_numbers.sh"
+# Runs a program and reports "<elapsed_seconds> <max_rss_kib> <exit_status>" (built by 'make tools')
+MEASURE="../tools/measure"
+MEASURE_REPORT="measure.log"
+# Fits the in-process (N, time) samples against O(1) ... O(n^2) (built by 'make tools')
+COMPLEXITY_FIT="../tools/complexity_fit"
+SAMPLES_FILE="samples.txt"
+# gtest-linked benchmark calling mergeInsertSort directly (built by 'make ex02_bench')
+BENCH_APP="../ex02_bench_app"
+BENCH_SIZES=(1000 10000 100000 1000000 10000000)
+# Sizes for the input-distribution matrix (sorted, reversed, organ-pipe, ... see PmergeData.hpp)
+DIST_SIZES=(1000 10000 30000)
+# Sizes for the per-recursion-depth allocation profile
+ALLOC_SIZES=(10000)
+# Sizes for checking the program's own "Time to process" lines against parse and sort times
+SELF_REPORT_SIZES=(1000 3000)
+# Sizes for the perf_event_open counters (instructions, cache and branch misses)
+COUNTER_SIZES=(1000 10000 100000)
+# Sizes for the stdout cost profile (bytes, write calls and write(2) time, /dev/null vs pipe)
+OUTPUT_SIZES=(1000 10000 50000)
+# LD_PRELOAD shim counting write(2)/writev(2) per file descriptor (built by 'make tools', Linux only)
+WRITE_AUDIT="../tools/write_audit.so"
 
 # Array of dataset sizes to test
 TEST_SIZES=(500 3000 5000 10000)
@@ -29,6 +50,11 @@ if [ ! -x "$NUM_GENERATOR" ]; then
     echo -e "${YELLOW}Please run 'chmod +x $NUM_GENERATOR'.${NC}"
     exit 1
 fi
+if [ ! -x "$MEASURE" ] || [ ! -x "$COMPLEXITY_FIT" ]; then
+    echo -e "${RED}Error: '$MEASURE' or '$COMPLEXITY_FIT' not found.${NC}"
+    echo -e "${YELLOW}Please build them first with 'make tools' in the cpp09 directory.${NC}"
+    exit 1
+fi
 
 # --- Test Execution ---
 echo -e "--- Running Performance Tests for PmergeMe ---"
@@ -45,12 +71,17 @@ for N in "${TEST_SIZES[@]}"; do
     echo "Generating $N random numbers..."
     INPUT_SEQUENCE=$("$NUM_GENERATOR" "$N")
 
-    # 2. Run the PmergeMe program using xargs to avoid "Argument list too long"
+    # 2. Run the PmergeMe program directly (these sizes fit in ARG_MAX; xargs would
+    # split a longer list into several runs) and measure its wall time.
     # The PmergeMe program will print its own timing results.
-    echo "$INPUT_SEQUENCE" | xargs "$EXECUTABLE"
+    "$MEASURE" -o "$MEASURE_REPORT" "$EXECUTABLE" $INPUT_SEQUENCE
+    read -r EXEC_TIME _ EXIT_STATUS < "$MEASURE_REPORT"
+    rm -f "$MEASURE_REPORT"
 
-    if [ $? -ne 0 ]; then
+    if [ "$EXIT_STATUS" -ne 0 ]; then
         echo -e "${RED}Error: PmergeMe failed for $N elements.${NC}"
+    else
+        echo -e "Wall time of the whole run: ${CYAN}$(awk -v t="$EXEC_TIME" 'BEGIN { printf "%.3fs", t }')${NC}"
     fi
 done
 
@@ -62,3 +93,45 @@ echo -e "${GREEN}=====================================================${NC}"
 echo "Review the output above to compare the performance."
 echo "Does std::vector or std::deque perform better as N increases?"
 echo "This demonstrates the trade-off between random access speed and insertion cost."
+
+# --- In-process Large-N Benchmark ---
+# Beyond ARG_MAX the numbers cannot be passed as arguments; sort them in memory instead.
+# The wall times above include process startup and printing, so the complexity fit
+# uses these sort-only times. Merge-insertion is expected to be O(n log n) for both
+# containers; the stage fails only if either clearly fits a worse class.
+FIT_STATUS=0
+if [ -x "$BENCH_APP" ]; then
+    echo ""
+    rm -f "$SAMPLES_FILE"
+    BENCH_SAMPLES="$SAMPLES_FILE" PMERGE_BENCH_SIZES="${BENCH_SIZES[*]}" \
+        "$BENCH_APP" --gtest_filter=PmergeMeBench.LargeInputs --gtest_brief=1
+    for SERIES in merge_insert_vector merge_insert_deque; do
+        echo ""
+        echo "$SERIES:"
+        awk -v series="$SERIES" '$1 == series { print $2, $3 }' "$SAMPLES_FILE" | "$COMPLEXITY_FIT" --expect nlogn \
+            || FIT_STATUS=$?
+    done
+    rm -f "$SAMPLES_FILE"
+    # Uniform random input hides how the algorithm and the containers react to the input's shape.
+    echo ""
+    PMERGE_DIST_SIZES="${DIST_SIZES[*]}" "$BENCH_APP" --gtest_filter=PmergeMeBench.DistributionMatrix --gtest_brief=1
+    # Heap churn per recursion level often explains the timings better than the wall clock.
+    echo ""
+    # Heap counting is opt-in, so the timing benchmarks run on the plain allocator.
+    BENCH_COUNT_ALLOCS=1 PMERGE_ALLOC_SIZES="${ALLOC_SIZES[*]}" \
+        "$BENCH_APP" --gtest_filter=PmergeMeBench.AllocationsByDepth --gtest_brief=1
+    # Some programs include argument parsing in their reported time and some do not.
+    echo ""
+    PMERGE_EXECUTABLE="$EXECUTABLE" PMERGE_SELF_SIZES="${SELF_REPORT_SIZES[*]}" \
+        "$BENCH_APP" --gtest_filter=PmergeMeBench.SelfReportedTime --gtest_brief=1
+    # Counters answer "vector or deque?" more steadily than the wall clock.
+    echo ""
+    PMERGE_COUNTER_SIZES="${COUNTER_SIZES[*]}" "$BENCH_APP" --gtest_filter=PmergeMeBench.Counters --gtest_brief=1
+    # Printing every number of Before/After can cost more than the sort; separate it from the algorithm.
+    echo ""
+    PMERGE_EXECUTABLE="$EXECUTABLE" PMERGE_WRITE_AUDIT="$WRITE_AUDIT" PMERGE_OUTPUT_SIZES="${OUTPUT_SIZES[*]}" \
+        "$BENCH_APP" --gtest_filter=PmergeMeBench.OutputCost --gtest_brief=1
+else
+    echo -e "${YELLOW}Skip in-process benchmark: '$BENCH_APP' not found (build it with 'make ex02_bench').${NC}"
+fi
+exit $FIT_STATUS
@@ -0,0 +1,98 @@
+// btc_dbgen : deterministic database / input file generator for cpp09/ex00.
+//
+// Usage: btc_dbgen <rows> [-m db|input] [-s seed] [-g gap] [-S shape] [-b YYYY-MM-DD] [-d days] [-o file]
+//   -m mode  "db" writes "date,exchange_rate" rows (default),
+//            "input" writes "date | value" query lines for the btc program
+//   -s seed  PRNG seed (default 42). The same arguments always give the same bytes.
+//   -g gap   db: days between rows: daily, fixed:N, uniform:A-B, geometric:MEAN (default daily)
+//   -S shape db: comma-separated list of descending, dup:FRACTION (rows repeating the
+//            previous date), longrate:DIGITS (extra rate digits) and crlf
+//   -b date  db: date of the first row / input: earliest query date (default 2009-01-02)
+//   -d days  input: query dates are drawn from [-b date, -b date + days) (default 3650)
+//   -o file  Output file (default stdout)
+
+#include "BtcData.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+static int usage(const char *prog) {
+    std::cerr << "Usage: " << prog << " <rows> [-m db|input] [-s seed]"
+              << " [-g daily|fixed:N|uniform:A-B|geometric:MEAN] [-S descending,dup:F,longrate:N,crlf]"
+              << " [-b YYYY-MM-DD] [-d days] [-o file]" << std::endl;
+    return 1;
+}
+
+static bool parseDate(const char *s, long &day) {
+    unsigned y, m, d;
+    char tail;
+    if (std::strlen(s) != 10 || std::sscanf(s, "%4u-%2u-%2u%c", &y, &m, &d, &tail) != 3)
+        return false;
+    day = BtcData::daysFromCivil(y, m, d);
+    // Round-trip to reject 2021-02-29 and friends.
+    return y >= 1 && BtcData::dateString(day) == s;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2)
+        return usage(argv[0]);
+    char *end;
+    const unsigned long long rows = std::strtoull(argv[1], &end, 10);
+    if (*argv[1] == '\0' || *end != '\0')
+        return usage(argv[0]);
+
+    BtcData::DbSpec spec(static_cast<size_t>(rows));
+    BtcData::InputSpec input(static_cast<size_t>(rows));
+    std::string mode = "db";
+    std::string output = "-";
+    for (int i = 2; i < argc; ++i) {
+        if (i + 1 >= argc)
+            return usage(argv[0]);
+        const std::string opt = argv[i];
+        const char *value = argv[++i];
+        if (opt == "-m") {
+            mode = value;
+            if (mode != "db" && mode != "input")
+                return usage(argv[0]);
+        } else if (opt == "-s") {
+            spec.seed = std::strtoull(value, &end, 10);
+            if (*end != '\0')
+                return usage(argv[0]);
+        } else if (opt == "-d") {
+            input.spanDays = std::strtol(value, &end, 10);
+            if (*end != '\0' || input.spanDays < 1)
+                return usage(argv[0]);
+        } else if (opt == "-g") {
+            if (!BtcData::GapSpec::parse(value, spec.gap))
+                return usage(argv[0]);
+        } else if (opt == "-S") {
+            if (!spec.parseShape(value))
+                return usage(argv[0]);
+        } else if (opt == "-b") {
+            if (!parseDate(value, spec.startDay))
+                return usage(argv[0]);
+        } else if (opt == "-o") {
+            output = value;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    try {
+        if (mode == "input") {
+            input.seed = spec.seed;
+            input.startDay = spec.startDay;
+            BtcData::writeInput(output, input);
+            return 0;
+        }
+        const size_t wraps = BtcData::writeDatabase(output, spec);
+        if (wraps)
+            std::cerr << "btc_dbgen: warning: dates ran out of the calendar " << wraps
+                      << " time(s); the database contains duplicate dates." << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << "btc_dbgen: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
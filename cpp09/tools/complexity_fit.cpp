@@ -0,0 +1,197 @@
+// complexity_fit : classifies (size, time) samples into a complexity class.
+//
+// Usage: complexity_fit --expect <class> [-t tolerance] [-c min_confidence] [samples_file]
+//   <class>         1, logn, n, nlogn or n2
+//   tolerance       Relative residual margin under which two classes count as a
+//                   tie and the simpler one wins (default 0.10)
+//   min_confidence  Confidence a worse fit needs before it fails (default 0.50);
+//                   below it the verdict is printed but does not change the status
+//   Samples are read from samples_file (or stdin), one "<size> <time>" pair per
+//   line; blank lines and lines starting with '#' are ignored.
+//
+// Each class f is fitted as time = a + b * f(size) by least squares (b >= 0).
+// The best fit is the class with the smallest residual, preferring the simpler
+// class on ties. Confidence is how much better it fits than the best other
+// class (1 - rss_best / rss_other). Exit status:
+//   0  the measured class is the expected one or better
+//   1  the measured class is worse, the expected class clearly fits worse and
+//      the confidence is at least min_confidence
+//   2  usage error or not enough samples
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct ComplexityClass {
+    const char *name;
+    const char *label;
+    double (*f)(double);
+};
+
+double constant(double) { return 0.0; }
+double logN(double n) { return std::log2(n); }
+double linear(double n) { return n; }
+double nLogN(double n) { return n * std::log2(n); }
+double quadratic(double n) { return n * n; }
+
+// Ordered from the simplest to the most expensive.
+const ComplexityClass kClasses[] = {
+    {"1", "O(1)", constant},       {"logn", "O(log n)", logN},       {"n", "O(n)", linear},
+    {"nlogn", "O(n log n)", nLogN}, {"n2", "O(n^2)", quadratic},
+};
+const int kClassCount = sizeof(kClasses) / sizeof(kClasses[0]);
+
+struct Fit {
+    double a;
+    double b;
+    double rss;
+};
+
+// Least squares of y = a + b * x, with b clamped to 0 when the slope is negative.
+Fit fitLine(const std::vector<double> &x, const std::vector<double> &y) {
+    const double n = static_cast<double>(x.size());
+    double sx = 0, sy = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        sx += x[i];
+        sy += y[i];
+    }
+    const double mx = sx / n, my = sy / n;
+    double sxx = 0, sxy = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        sxx += (x[i] - mx) * (x[i] - mx);
+        sxy += (x[i] - mx) * (y[i] - my);
+    }
+    Fit fit;
+    fit.b = sxx > 0 && sxy > 0 ? sxy / sxx : 0.0;
+    fit.a = my - fit.b * mx;
+    fit.rss = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        const double r = y[i] - (fit.a + fit.b * x[i]);
+        fit.rss += r * r;
+    }
+    return fit;
+}
+
+int findClass(const std::string &name) {
+    for (int i = 0; i < kClassCount; ++i) {
+        if (name == kClasses[i].name)
+            return i;
+    }
+    return -1;
+}
+
+int usage(const char *prog) {
+    std::cerr << "Usage: " << prog << " --expect 1|logn|n|nlogn|n2 [-t tolerance] [-c min_confidence] [samples_file]"
+              << std::endl;
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int expected = -1;
+    double tolerance = 0.10;
+    double minConfidence = 0.50;
+    const char *path = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--expect") == 0 && i + 1 < argc) {
+            expected = findClass(argv[++i]);
+            if (expected < 0)
+                return usage(argv[0]);
+        } else if (std::strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            tolerance = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            minConfidence = std::atof(argv[++i]);
+        } else if (path == NULL) {
+            path = argv[i];
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (expected < 0)
+        return usage(argv[0]);
+
+    std::ifstream file;
+    if (path != NULL) {
+        file.open(path);
+        if (!file) {
+            std::cerr << "complexity_fit: cannot open " << path << std::endl;
+            return 2;
+        }
+    }
+    std::istream &in = path != NULL ? static_cast<std::istream &>(file) : std::cin;
+
+    std::vector<double> sizes, times;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream iss(line);
+        double size, time;
+        if (iss >> size >> time && size >= 1) {
+            sizes.push_back(size);
+            times.push_back(time);
+        }
+    }
+    if (sizes.size() < 3) {
+        std::cerr << "complexity_fit: need at least 3 samples, got " << sizes.size() << std::endl;
+        return 2;
+    }
+
+    double mean = 0;
+    for (size_t i = 0; i < times.size(); ++i)
+        mean += times[i];
+    mean /= static_cast<double>(times.size());
+    double tss = 0;
+    for (size_t i = 0; i < times.size(); ++i)
+        tss += (times[i] - mean) * (times[i] - mean);
+
+    Fit fits[kClassCount];
+    int best = 0;
+    for (int c = 0; c < kClassCount; ++c) {
+        std::vector<double> x(sizes.size());
+        for (size_t i = 0; i < sizes.size(); ++i)
+            x[i] = kClasses[c].f(sizes[i]);
+        fits[c] = fitLine(x, times);
+        if (fits[c].rss < fits[best].rss)
+            best = c;
+    }
+    // On a tie within the tolerance the simpler class wins.
+    const double bestRss = fits[best].rss;
+    for (int c = 0; c < best; ++c) {
+        if (fits[c].rss <= bestRss * (1.0 + tolerance) + 1e-300) {
+            best = c;
+            break;
+        }
+    }
+    double otherRss = -1;
+    for (int c = 0; c < kClassCount; ++c) {
+        if (c != best && (otherRss < 0 || fits[c].rss < otherRss))
+            otherRss = fits[c].rss;
+    }
+    double confidence = otherRss > 0 ? 1.0 - fits[best].rss / otherRss : 0.0;
+    if (confidence < 0)
+        confidence = 0;
+
+    std::printf("Complexity fit of %zu samples (time = a + b * f(n)):\n", sizes.size());
+    for (int c = 0; c < kClassCount; ++c) {
+        const double r2 = tss > 0 ? 1.0 - fits[c].rss / tss : 1.0;
+        std::printf("  %-11s R^2=%7.4f  b=%-12.4g%s\n", kClasses[c].label, r2, fits[c].b, c == best ? "  <= best" : "");
+    }
+
+    const bool worse = best > expected && fits[expected].rss > fits[best].rss * (1.0 + tolerance);
+    // A few noisy samples can fit a worse class by chance; only a clear fit fails.
+    const bool fails = worse && confidence >= minConfidence;
+    std::printf("Best fit: %s (confidence %.2f), expected %s: %s\n", kClasses[best].label, confidence,
+                kClasses[expected].label,
+                fails ? "WORSE" : worse ? "OK (worse, but below the confidence threshold)" : "OK");
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,265 @@
+// golden_runner : runs golden-file test cases concurrently and diffs them in memory.
+//
+// Usage: golden_runner [-j jobs] <case_table> <executable>
+//   jobs        Maximum number of cases running at once (default 64)
+//   case_table  One case per line, in the shape of the old run_test calls:
+//                 run_test "<description>" "<command>" "<expected stdout>" "<expected stderr>"
+//               The leading "run_test" is optional, a trailing '\' continues
+//               the case on the next line, and lines starting with '#' are
+//               comments. $EXECUTABLE in the command is replaced by <executable>;
+//               the command is split on spaces and run without a shell. An empty
+//               expected file ("") skips that stream.
+//
+// Every case is one fork/exec; its stdout and stderr are read through pipes and
+// compared with the expected files without temporary files or diff processes.
+// Results are printed in table order as [ OK ] / [ KO ] lines, followed by a
+// summary. The exit status is 0 when every case passed and 1 otherwise.
+
+#include "Subprocess.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <poll.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char *kGreen = "\033[0;32m";
+const char *kRed = "\033[0;31m";
+const char *kYellow = "\033[0;33m";
+const char *kNoColor = "\033[0m";
+
+struct Case {
+    std::string description;
+    std::vector<std::string> args;
+    std::string expectedOut; // Path, empty to skip the check
+    std::string expectedErr;
+};
+
+struct Run {
+    Subprocess::Child child;
+    Subprocess::Result result;
+    std::string out;
+    std::string err;
+    bool spawned;
+    bool done;
+
+    Run() : spawned(false), done(false) {}
+};
+
+// Splits a line into its double-quoted fields; a bare word before the first quote is ignored.
+std::vector<std::string> quotedFields(const std::string &line) {
+    std::vector<std::string> fields;
+    size_t pos = 0;
+    while ((pos = line.find('"', pos)) != std::string::npos) {
+        const size_t end = line.find('"', pos + 1);
+        if (end == std::string::npos)
+            break;
+        fields.push_back(line.substr(pos + 1, end - pos - 1));
+        pos = end + 1;
+    }
+    return fields;
+}
+
+std::vector<std::string> splitCommand(std::string command, const std::string &executable) {
+    const std::string var = "$EXECUTABLE";
+    for (size_t pos; (pos = command.find(var)) != std::string::npos;)
+        command.replace(pos, var.size(), executable);
+    std::istringstream iss(command);
+    std::vector<std::string> args;
+    std::string word;
+    while (iss >> word)
+        args.push_back(word);
+    return args;
+}
+
+bool loadCases(const char *path, const std::string &executable, std::vector<Case> &cases) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "golden_runner: cannot open " << path << std::endl;
+        return false;
+    }
+    std::string line, entry;
+    int lineNo = 0;
+    while (std::getline(file, line)) {
+        ++lineNo;
+        if (entry.empty() && (line.empty() || line[0] == '#'))
+            continue;
+        if (!line.empty() && line[line.size() - 1] == '\\') {
+            entry += line.substr(0, line.size() - 1);
+            continue;
+        }
+        entry += line;
+        const std::vector<std::string> fields = quotedFields(entry);
+        entry.clear();
+        if (fields.size() != 4) {
+            std::cerr << "golden_runner: " << path << ":" << lineNo << ": expected 4 quoted fields" << std::endl;
+            return false;
+        }
+        Case c;
+        c.description = fields[0];
+        c.args = splitCommand(fields[1], executable);
+        c.expectedOut = fields[2];
+        c.expectedErr = fields[3];
+        if (c.args.empty()) {
+            std::cerr << "golden_runner: " << path << ":" << lineNo << ": empty command" << std::endl;
+            return false;
+        }
+        cases.push_back(c);
+    }
+    return true;
+}
+
+// Expected files are shared by many cases (expected_empty.txt), so each is read once.
+const std::string *expectedContent(const std::string &path, std::map<std::string, std::string> &cache) {
+    std::map<std::string, std::string>::iterator it = cache.find(path);
+    if (it == cache.end()) {
+        std::ifstream file(path.c_str(), std::ios::binary);
+        if (!file)
+            return NULL;
+        std::ostringstream content;
+        content << file.rdbuf();
+        it = cache.insert(std::make_pair(path, content.str())).first;
+    }
+    return &it->second;
+}
+
+bool matches(const std::string &expectedPath, const std::string &actual, std::map<std::string, std::string> &cache) {
+    if (expectedPath.empty())
+        return true;
+    const std::string *expected = expectedContent(expectedPath, cache);
+    return expected != NULL && *expected == actual;
+}
+
+void printDetail(const char *stream, const std::string &expectedPath, const std::string &actual,
+                 std::map<std::string, std::string> &cache) {
+    if (expectedPath.empty())
+        return;
+    const std::string *expected = expectedContent(expectedPath, cache);
+    std::cout << "--- Expected " << stream << " (" << expectedPath << ") ---" << std::endl;
+    std::cout << (expected != NULL ? *expected : "(cannot open " + expectedPath + ")\n");
+    std::cout << "--- Actual " << stream << " ---" << std::endl;
+    std::cout << actual;
+    std::cout << "--------------------" << std::endl;
+}
+
+// Returns true if the case passed.
+bool report(const Case &c, const Run &run, std::map<std::string, std::string> &cache) {
+    if (!run.spawned) {
+        std::cout << "[ " << kRed << "KO" << kNoColor << " ] " << c.description << " (could not start "
+                  << c.args[0] << ")" << std::endl;
+        return false;
+    }
+    if (matches(c.expectedOut, run.out, cache) && matches(c.expectedErr, run.err, cache)) {
+        std::cout << "[ " << kGreen << "OK" << kNoColor << " ] " << c.description << std::endl;
+        return true;
+    }
+    std::cout << "[ " << kRed << "KO" << kNoColor << " ] " << c.description << std::endl;
+    printDetail("STDOUT", c.expectedOut, run.out, cache);
+    printDetail("STDERR", c.expectedErr, run.err, cache);
+    return false;
+}
+
+int usage(const char *prog) {
+    std::cerr << "Usage: " << prog << " [-j jobs] <case_table> <executable>" << std::endl;
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    size_t jobs = 64;
+    int first = 1;
+    if (argc > 2 && std::strcmp(argv[1], "-j") == 0) {
+        jobs = static_cast<size_t>(std::strtoul(argv[2], NULL, 10));
+        first = 3;
+    }
+    if (argc - first != 2 || jobs == 0)
+        return usage(argv[0]);
+
+    std::vector<Case> cases;
+    if (!loadCases(argv[first], argv[first + 1], cases))
+        return 2;
+
+    std::vector<Run> runs(cases.size());
+    std::vector<size_t> active; // Spawned cases with an open pipe or not reaped yet
+    std::map<std::string, std::string> cache;
+    size_t next = 0, printed = 0, passed = 0;
+    const double start = Subprocess::monotonicSec();
+
+    while (printed < cases.size()) {
+        while (active.size() < jobs && next < cases.size()) {
+            Run &run = runs[next];
+            run.spawned = Subprocess::spawnCaptured(cases[next].args, run.child);
+            if (run.spawned)
+                active.push_back(next);
+            else
+                run.done = true;
+            ++next;
+        }
+
+        std::vector<struct pollfd> fds;
+        std::vector<std::string *> sinks;
+        std::vector<int *> owners;
+        for (size_t i = 0; i < active.size(); ++i) {
+            Run &run = runs[active[i]];
+            int *ends[2] = {&run.child.outFd, &run.child.errFd};
+            std::string *bufs[2] = {&run.out, &run.err};
+            for (int k = 0; k < 2; ++k) {
+                if (*ends[k] < 0)
+                    continue;
+                struct pollfd p;
+                p.fd = *ends[k];
+                p.events = POLLIN;
+                p.revents = 0;
+                fds.push_back(p);
+                sinks.push_back(bufs[k]);
+                owners.push_back(ends[k]);
+            }
+        }
+        if (!fds.empty() && poll(&fds[0], fds.size(), -1) > 0) {
+            for (size_t i = 0; i < fds.size(); ++i) {
+                if (fds[i].revents != 0)
+                    Subprocess::drain(*owners[i], *sinks[i]);
+            }
+        }
+
+        // Reap the cases whose both pipes reached EOF.
+        for (size_t i = 0; i < active.size();) {
+            Run &run = runs[active[i]];
+            if (run.child.outFd < 0 && run.child.errFd < 0) {
+                Subprocess::reap(run.child.pid, run.child.startSec, run.result);
+                run.done = true;
+                active[i] = active.back();
+                active.pop_back();
+            } else {
+                ++i;
+            }
+        }
+
+        // Print in table order as soon as the leading cases are finished.
+        while (printed < cases.size() && runs[printed].done) {
+            if (report(cases[printed], runs[printed], cache))
+                ++passed;
+            ++printed;
+        }
+    }
+
+    const double elapsed = Subprocess::monotonicSec() - start;
+    std::cout << "---------------------------------------------------" << std::endl;
+    if (passed == cases.size()) {
+        std::cout << kGreen << "All " << cases.size() << " tests passed successfully!" << kNoColor << std::endl;
+    } else {
+        std::cout << kRed << cases.size() - passed << " out of " << cases.size() << " tests failed." << kNoColor
+                  << std::endl;
+    }
+    std::cout << kYellow << cases.size() << " cases in " << std::fixed << std::setprecision(3) << elapsed << "s ("
+              << jobs << " at a time)" << kNoColor << std::endl;
+    std::cout << "---------------------------------------------------" << std::endl;
+    return passed == cases.size() ? 0 : 1;
+}
@@ -0,0 +1,40 @@
+// measure : runs a program and reports its wall time and peak RSS.
+//
+// Usage: measure [-o report_file] <program> [args...]
+//   The program inherits stdin/stdout/stderr. One line is written to
+//   report_file (or stderr):
+//     <elapsed_seconds> <max_rss_kib> <exit_status>
+//   Wall time comes from clock_gettime(CLOCK_MONOTONIC) around fork/exec and
+//   the peak RSS from wait4(), so no /usr/bin/time (10 ms resolution) is needed.
+//   The exit status of measure is the exit status of the program.
+
+#include "Subprocess.hpp"
+#include <cstdio>
+#include <cstring>
+
+int main(int argc, char **argv) {
+    int first = 1;
+    const char *reportPath = NULL;
+    if (argc > 2 && std::strcmp(argv[1], "-o") == 0) {
+        reportPath = argv[2];
+        first = 3;
+    }
+    if (first >= argc) {
+        std::fprintf(stderr, "Usage: %s [-o report_file] <program> [args...]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<std::string> args(argv + first, argv + argc);
+    const Subprocess::Result r = Subprocess::run(args);
+    const int code = WIFEXITED(r.status) ? WEXITSTATUS(r.status) : 128 + WTERMSIG(r.status);
+
+    std::FILE *report = reportPath ? std::fopen(reportPath, "w") : stderr;
+    if (report == NULL) {
+        std::perror(reportPath);
+        return 2;
+    }
+    std::fprintf(report, "%.6f %ld %d\n", r.elapsedSec, r.maxRssKb, code);
+    if (report != stderr)
+        std::fclose(report);
+    return code;
+}
@@ -0,0 +1,251 @@
+// pmerge_check : verifies the output of one PmergeMe run.
+//
+// Usage: pmerge_check [-i input_file] [output_file]
+//   output_file  Captured stdout of PmergeMe (default: stdin)
+//   input_file   The numbers that were passed to PmergeMe, separated by
+//                whitespace. Without it the "Before:" line is taken as the input.
+//
+// The "Before:" and "After:" lines are parsed in one pass over the buffer, then
+//   1. "After:" must be in non-decreasing order, and
+//   2. "After:" must be a permutation of the input. A keyed multiset
+//      fingerprint of both lists is compared first (one pass, no extra memory);
+//      if it differs, the input is radix sorted (LSD, 11 bits per pass, O(n))
+//      and compared element by element to report the first difference.
+// With -i, the "Before:" line must also match the input in order, unless the
+// program shortens it (e.g. "[...]"), which is allowed.
+// A 10M-element output (80 to 200 MB) is checked in well under a second;
+// reading and parsing the text is most of the time.
+// The exit status is 0 when the output is correct, 1 when it is not and 2 on
+// usage or I/O errors; the reason is printed on stderr.
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+namespace {
+
+typedef unsigned int Value;
+
+// Parsed numbers of one line. `complete` is false if the line had a token that
+// is not a number (a shortened "[...]" list) or a number that does not fit.
+struct Numbers {
+    bool found;
+    bool complete;
+    std::vector<Value> values;
+    Numbers() : found(false), complete(true) {}
+};
+
+bool readAll(std::FILE *f, std::string &out) {
+    char chunk[1 << 20];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0)
+        out.append(chunk, n);
+    return !std::ferror(f);
+}
+
+bool readFile(const char *path, std::string &out) {
+    std::FILE *f = std::fopen(path, "rb");
+    if (f == NULL) {
+        std::perror(path);
+        return false;
+    }
+    // One allocation of the right size instead of growing chunk by chunk
+    struct stat st;
+    if (fstat(fileno(f), &st) == 0 && st.st_size > 0)
+        out.reserve(static_cast<size_t>(st.st_size));
+    const bool ok = readAll(f, out);
+    if (!ok)
+        std::perror(path);
+    std::fclose(f);
+    return ok;
+}
+
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f'; }
+
+// Parses whitespace-separated unsigned numbers in [p, end) into `numbers`.
+// *end must not be a digit (it is the '\n' of the line or the terminating '\0'
+// of the buffer), so the digit loop needs no bounds check.
+void parseNumbers(const char *p, const char *end, Numbers &numbers) {
+    numbers.found = true;
+    // Upper bound (a digit and a separator per number); untouched pages cost nothing
+    numbers.values.reserve(static_cast<size_t>(end - p) / 2 + 1);
+    while (p < end) {
+        while (p < end && isSpace(*p))
+            ++p;
+        if (p == end)
+            break;
+        const char *start = p;
+        unsigned long long x = 0;
+        while (static_cast<unsigned>(*p - '0') < 10u)
+            x = x * 10 + static_cast<unsigned>(*p++ - '0');
+        if (p == start || p - start > 10 || (p < end && !isSpace(*p)) || x > 0xffffffffULL) {
+            numbers.complete = false;
+            while (p < end && !isSpace(*p))
+                ++p;
+            continue;
+        }
+        numbers.values.push_back(static_cast<Value>(x));
+    }
+}
+
+// Parses the first "Before:" and the first "After:" line (leading blanks are
+// skipped) in one pass; the rest of the output is not looked at.
+void scan(const std::string &text, Numbers &before, Numbers &after) {
+    const char *p = text.data();
+    const char *end = p + text.size();
+    while (p < end && !(before.found && after.found)) {
+        const char *eol = static_cast<const char *>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (eol == NULL)
+            eol = end;
+        const char *q = p;
+        while (q < eol && (*q == ' ' || *q == '\t'))
+            ++q;
+        const size_t len = static_cast<size_t>(eol - q);
+        if (!before.found && len >= 7 && std::memcmp(q, "Before:", 7) == 0)
+            parseNumbers(q + 7, eol, before);
+        else if (!after.found && len >= 6 && std::memcmp(q, "After:", 6) == 0)
+            parseNumbers(q + 6, eol, after);
+        p = eol + (eol < end ? 1 : 0);
+    }
+}
+
+// LSD radix sort, 11 bits per pass: three passes over 32-bit values, with all
+// three histograms built in a single pass beforehand.
+void radixSort(std::vector<Value> &v) {
+    const unsigned kBits = 11;
+    const size_t kBuckets = 1u << kBits;
+    std::vector<size_t> count(3 * kBuckets, 0);
+    for (size_t i = 0; i < v.size(); ++i) {
+        ++count[v[i] & (kBuckets - 1)];
+        ++count[kBuckets + ((v[i] >> kBits) & (kBuckets - 1))];
+        ++count[2 * kBuckets + (v[i] >> (2 * kBits))];
+    }
+    std::vector<Value> tmp(v.size());
+    for (unsigned pass = 0; pass < 3; ++pass) {
+        size_t *c = &count[pass * kBuckets];
+        const unsigned shift = pass * kBits;
+        // Every value has the same digit here: the pass would not move anything
+        bool trivial = false;
+        size_t sum = 0;
+        for (size_t b = 0; b < kBuckets; ++b) {
+            trivial = trivial || c[b] == v.size();
+            const size_t n = c[b];
+            c[b] = sum;
+            sum += n;
+        }
+        if (trivial)
+            continue;
+        for (size_t i = 0; i < v.size(); ++i)
+            tmp[c[(v[i] >> shift) & (kBuckets - 1)]++] = v[i];
+        v.swap(tmp);
+    }
+}
+
+// Order-independent fingerprint of a multiset: the sum of a keyed 64-bit mix
+// (splitmix64 finalizer) of every value. Two different multisets have the same
+// sum with probability about 2^-64 for a key the program under test cannot know.
+unsigned long long fingerprint(const std::vector<Value> &v, unsigned long long key) {
+    unsigned long long sum = 0;
+    for (size_t i = 0; i < v.size(); ++i) {
+        unsigned long long z = (v[i] ^ key) + 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        sum += z ^ (z >> 31);
+    }
+    return sum;
+}
+
+// Prints the reason on stderr and returns the exit status for a wrong output.
+int fail(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    std::vfprintf(stderr, format, args);
+    va_end(args);
+    std::fputc('\n', stderr);
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    const char *inputPath = NULL;
+    int first = 1;
+    if (argc > 2 && std::strcmp(argv[1], "-i") == 0) {
+        inputPath = argv[2];
+        first = 3;
+    }
+    if (argc - first > 1) {
+        std::fprintf(stderr, "Usage: %s [-i input_file] [output_file]\n", argv[0]);
+        return 2;
+    }
+
+    std::string output;
+    if (first < argc) {
+        if (!readFile(argv[first], output))
+            return 2;
+    } else if (!readAll(stdin, output)) {
+        std::perror("stdin");
+        return 2;
+    }
+
+    Numbers before, after;
+    scan(output, before, after);
+    if (!before.found || !after.found) {
+        return fail("Missing %s line", before.found ? "\"After:\"" : "\"Before:\"");
+    }
+    if (!after.complete)
+        return fail("\"After:\" has a token that is not a number; the full list is needed");
+
+    Numbers input;
+    if (inputPath != NULL) {
+        std::string text;
+        if (!readFile(inputPath, text))
+            return 2;
+        parseNumbers(text.data(), text.data() + text.size(), input);
+        if (!input.complete) {
+            std::fprintf(stderr, "%s: not a list of unsigned numbers\n", inputPath);
+            return 2;
+        }
+        if (before.complete && before.values.size() != input.values.size())
+            return fail("\"Before:\" has %zu numbers, the input has %zu", before.values.size(),
+                        input.values.size());
+        for (size_t i = 0; before.complete && i < before.values.size(); ++i) {
+            if (before.values[i] != input.values[i])
+                return fail("\"Before:\" differs from the input at position %zu: %u, expected %u", i,
+                            before.values[i], input.values[i]);
+        }
+    } else if (!before.complete) {
+        return fail("\"Before:\" is shortened; pass the input with -i");
+    } else {
+        input.values.swap(before.values);
+    }
+
+    const std::vector<Value> &sorted = after.values;
+    if (sorted.size() != input.values.size())
+        return fail("\"After:\" has %zu numbers, the input has %zu", sorted.size(), input.values.size());
+    for (size_t i = 1; i < sorted.size(); ++i) {
+        if (sorted[i - 1] > sorted[i])
+            return fail("\"After:\" is not sorted at position %zu: %u > %u", i, sorted[i - 1], sorted[i]);
+    }
+    // The fingerprint settles the common case in one pass; the exact (radix
+    // sorted) comparison only runs to find where the multisets differ.
+    std::random_device seed;
+    const unsigned long long key = (static_cast<unsigned long long>(seed()) << 32) | seed();
+    if (fingerprint(sorted, key) == fingerprint(input.values, key)) {
+        std::printf("OK: %zu numbers sorted\n", sorted.size());
+        return 0;
+    }
+    radixSort(input.values);
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        if (sorted[i] != input.values[i])
+            return fail("\"After:\" is not a permutation of the input: position %zu is %u, expected %u", i,
+                        sorted[i], input.values[i]);
+    }
+    // Unreachable unless the fingerprints collided
+    std::printf("OK: %zu numbers sorted\n", sorted.size());
+    return 0;
+}